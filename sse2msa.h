@@ -62,8 +62,14 @@
 #if defined(__GNUC__)
 #pragma push_macro("FORCE_INLINE")
 #pragma push_macro("ALIGN_STRUCT")
+#pragma push_macro("SHARED_TLS")
 #define FORCE_INLINE static inline __attribute__((always_inline))
 #define ALIGN_STRUCT(x) __attribute__((aligned(x)))
+/*
+ * Per-thread state seen by every translation unit: each one emits a weak
+ * definition and the linker keeps a single copy.
+ */
+#define SHARED_TLS __attribute__((weak)) __thread
 #else
 #error Unsupported compiler
 #endif
@@ -73,6 +79,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <math.h>
+#include <sched.h>
 
 #define SSE2MSA_NO_IMPL 0
 
@@ -90,6 +97,8 @@
 #define _MM_ROUND_UP 0x4000
 #define _MM_ROUND_TOWARD_ZERO 0x6000
 
+typedef int8_t v8i8 __attribute__((vector_size(8)));
+typedef int16_t v4i16 __attribute__((vector_size(8)));
 typedef int32_t v2i32 __attribute__((vector_size(8)));
 
 /* Ref: mmintrin.h emmintrin.h */
@@ -189,11 +198,65 @@ __extension__(({union {int64_t i; typeof(x) v;} $ = {.v = x}; $.i;}))
 #define vreinterpret_nth_u64_m128i(x, n) (((VREG128*)&x)->u64[n])
 #define vpreinterpret_nth_u64_m128d(p, n) (((VREG128*)p)->u64[n])
 
-FORCE_INLINE void _mm_prefetch(const void *p, int i)
-{
-	(void) i;
-	__builtin_prefetch(p);
-}
+/*
+ * `__m64` is kept in a 64-bit register (GPR on MIPS64) and moved to/from
+ * lane 0 of a MSA register with `fill.d`/`insert.d` and `copy_s.d`, so that
+ * MMX intrinsics never bounce through a VREG128 on the stack. The upper
+ * lane of `v_msa_fill_m64` holds a copy of the input, callers only rely on
+ * lane 0 of the result.
+ */
+#define vreinterpret_i64_m64(x) ((int64_t)(x))
+#define vreinterpret_m64_i64(x) ((__m64)(int64_t)(x))
+
+#define v_msa_fill_m64(type, x) \
+	((type)__builtin_msa_fill_d(vreinterpret_i64_m64(x)))
+#define v_msa_pack_m64(type, lo, hi) \
+	((type)__builtin_msa_insert_d(__builtin_msa_fill_d(     \
+	vreinterpret_i64_m64(lo)), 1, vreinterpret_i64_m64(hi)))
+#define v_msa_copy_m64(x) \
+	vreinterpret_m64_i64(__builtin_msa_copy_s_d(vreinterpret_v2i64(x), 0))
+
+/*
+ * MIPS `pref` hint codes. GCC already lowers __builtin_prefetch(p, rw, l)
+ * to pref (l == 0: streamed, l == 3: retained, else plain), so only
+ * PrepareForStore, which zeroes the line, needs inline asm.
+ */
+#define SSE2MSA_PREF_LOAD 0
+#define SSE2MSA_PREF_STORE 1
+#define SSE2MSA_PREF_LOAD_STREAMED 4
+#define SSE2MSA_PREF_STORE_STREAMED 5
+#define SSE2MSA_PREF_LOAD_RETAINED 6
+#define SSE2MSA_PREF_STORE_RETAINED 7
+#define SSE2MSA_PREF_PREPARE_FOR_STORE 30
+
+#define v_msa_pref(hint, p) \
+	__builtin_prefetch(p, (hint) & 1, (hint) >= 6 ? 3 : (hint) >= 4 ? 0 : 2)
+
+#if defined(__mips)
+#define v_msa_prepare_for_store(p) \
+	__asm__ __volatile__("pref %0, 0(%1)"                            \
+		:: "i"(SSE2MSA_PREF_PREPARE_FOR_STORE), "r"(p) : "memory")
+#else
+#define v_msa_prepare_for_store(p) __builtin_prefetch(p, 1, 0)
+#endif
+
+/* Ref: xmmintrin.h */
+#define _MM_HINT_ET0 7
+#define _MM_HINT_ET1 6
+#define _MM_HINT_T0 3
+#define _MM_HINT_T1 2
+#define _MM_HINT_T2 1
+#define _MM_HINT_NTA 0
+
+#define v_msa_pref_hint(i)                                   \
+	((i) == _MM_HINT_T0  ? SSE2MSA_PREF_LOAD_RETAINED :  \
+	 (i) == _MM_HINT_NTA ? SSE2MSA_PREF_LOAD_STREAMED :  \
+	 (i) == _MM_HINT_ET0 ? SSE2MSA_PREF_STORE_RETAINED : \
+	 (i) == _MM_HINT_ET1 ? SSE2MSA_PREF_STORE :          \
+	 SSE2MSA_PREF_LOAD)
+
+/* `i` must be a compile-time constant, as on x86 */
+#define _mm_prefetch(p, i) v_msa_pref(v_msa_pref_hint(i), (const void *)(p))
 
 FORCE_INLINE __m128i _mm_setzero_si128(void)
 {
@@ -230,10 +293,9 @@ FORCE_INLINE __m128 _mm_set_ps(float e3, float e2, float e1, float e0)
 
 FORCE_INLINE __m128 _mm_set_ss(float a)
 {
-	VREG128 v = {
-		.f32 = {a, 0, 0, 0}
-	};
-	return v.m128;
+	__m128 v = v_msa_setzero(__m128);
+	v[0] = a;
+	return v;
 }
 
 FORCE_INLINE __m128 _mm_setr_ps(float e3, float e2, float e1, float e0)
@@ -272,10 +334,7 @@ FORCE_INLINE __m128i _mm_setr_epi32(int e3, int e2, int e1, int e0)
 
 FORCE_INLINE __m128i _mm_setr_epi64(__m64 e1, __m64 e0)
 {
-	VREG128 v = {
-		.m64 = {e1, e0}
-	};
-	return v.m128i;
+	return v_msa_pack_m64(__m128i, e1, e0);
 }
 
 FORCE_INLINE __m128i _mm_set1_epi8(char a)
@@ -335,10 +394,7 @@ FORCE_INLINE __m128i _mm_set1_epi32(int a)
 
 FORCE_INLINE __m128i _mm_set1_epi64(__m64 a)
 {
-	VREG128 v = {
-		.m64 = {a, a}
-	};
-	return v.m128i;
+	return v_msa_fill_m64(__m128i, a);
 }
 
 FORCE_INLINE __m128i _mm_set1_epi64x(int64_t a)
@@ -367,10 +423,7 @@ FORCE_INLINE __m128i _mm_set_epi64x(int64_t e1, int64_t e0)
 
 FORCE_INLINE __m128i _mm_set_epi64(__m64 e1, __m64 e0)
 {
-	VREG128 v = {
-		.m64 = {e0, e1}
-	};
-	return v.m128i;
+	return v_msa_pack_m64(__m128i, e0, e1);
 }
 
 FORCE_INLINE __m128d _mm_set_pd(double e1, double e0)
@@ -383,10 +436,9 @@ FORCE_INLINE __m128d _mm_set_pd(double e1, double e0)
 
 FORCE_INLINE __m128d _mm_set_sd(double a)
 {
-	VREG128 v = {
-		.f64 = {a, 0}
-	};
-	return v.m128d;
+	__m128d v = v_msa_setzero(__m128d);
+	v[0] = a;
+	return v;
 }
 
 FORCE_INLINE __m128d _mm_set1_pd(double a)
@@ -410,8 +462,8 @@ FORCE_INLINE void _mm_storer_ps(float *p, __m128 a)
 
 FORCE_INLINE void _mm_storer_pd(double *p, __m128d a)
 {
-	p[0] = vreinterpret_nth_f64_m128d(a, 1);
-	p[1] = vreinterpret_nth_f64_m128d(a, 0);
+	__builtin_msa_st_w(__builtin_msa_shf_w(
+		vreinterpret_v4i32(a), 0x4e), p, 0);
 }
 
 FORCE_INLINE void _mm_store_ps1(float *p, __m128 a)
@@ -439,7 +491,7 @@ FORCE_INLINE void _mm_storeu_si128(__m128i *p, __m128i a)
 
 FORCE_INLINE void _mm_store_ss(float *p, __m128 a)
 {
-	*p = vreinterpret_nth_f32_m128(a, 0);
+	*p = a[0];
 }
 
 FORCE_INLINE void _mm_store_pd(double *p, __m128d a)
@@ -449,25 +501,26 @@ FORCE_INLINE void _mm_store_pd(double *p, __m128d a)
 
 FORCE_INLINE void _mm_store_pd1(double *p, __m128d a)
 {
-	p[0] = vreinterpret_nth_f64_m128d(a, 0);
-	p[1] = vreinterpret_nth_f64_m128d(a, 0);
+	__builtin_msa_st_d(__builtin_msa_splati_d(
+		vreinterpret_v2i64(a), 0), p, 0);
 }
 
 #define _mm_store1_pd _mm_store_pd1
 
 FORCE_INLINE void _mm_store_sd(double *p, __m128d a)
 {
-	p[0] = vreinterpret_nth_f64_m128d(a, 0);
+	*p = a[0];
 }
 
 FORCE_INLINE void _mm_storeh_pd(double *p, __m128d a)
 {
-	p[0] = vreinterpret_nth_f64_m128d(a, 1);
+	*p = vreinterpret_m128d(__builtin_msa_splati_d(
+		vreinterpret_v2i64(a), 1))[0];
 }
 
 FORCE_INLINE void _mm_storel_pd(double *p, __m128d a)
 {
-	p[0] = vreinterpret_nth_f64_m128d(a, 0);
+	*p = a[0];
 }
 
 FORCE_INLINE void _mm_storeu_pd(double *p, __m128d a)
@@ -475,63 +528,201 @@ FORCE_INLINE void _mm_storeu_pd(double *p, __m128d a)
 	__builtin_msa_st_d(vreinterpret_v2i64(a), p, 0);
 }
 
+/*
+ * Partial stores go out of the FPU register aliasing lane 0 (swc1/sdc1),
+ * or through copy_s for sub-word sizes; memcpy keeps unaligned `p` legal.
+ */
 FORCE_INLINE void _mm_storeu_si16(void *p, __m128i a)
 {
-	*((int16_t*)p) = vreinterpret_nth_i16_m128(a, 0);
+	int16_t x = __builtin_msa_copy_s_h(vreinterpret_v8i16(a), 0);
+	__builtin_memcpy(p, &x, sizeof(x));
 }
 
 FORCE_INLINE void _mm_storeu_si32(void *p, __m128i a)
 {
-	*((int32_t*)p) = vreinterpret_nth_i32_m128(a, 0);
+	float x = vreinterpret_m128(a)[0];
+	__builtin_memcpy(p, &x, sizeof(x));
 }
 
 FORCE_INLINE void _mm_storeu_si64(void *p, __m128i a)
 {
-	*((int64_t*)p) = vreinterpret_nth_i64_m128(a, 0);
+	double x = vreinterpret_m128d(a)[0];
+	__builtin_memcpy(p, &x, sizeof(x));
 }
 
 FORCE_INLINE void _mm_storel_epi64(__m128i *p, __m128i a)
 {
-	*((int64_t*)p) = vreinterpret_nth_i64_m128(a, 0);
+	_mm_storeu_si64(p, a);
 }
 
 FORCE_INLINE void _mm_storel_pi(__m64 *p, __m128 a)
 {
-	*(((float*)p) + 0) = vreinterpret_nth_f32_m128(a, 0);
-	*(((float*)p) + 1) = vreinterpret_nth_f32_m128(a, 1);
+	double x = vreinterpret_m128d(a)[0];
+	__builtin_memcpy(p, &x, sizeof(x));
 }
 
 FORCE_INLINE void _mm_storeh_pi(__m64 *p, __m128 a)
 {
-	*(((float*)p) + 0) = vreinterpret_nth_f32_m128(a, 2);
-	*(((float*)p) + 1) = vreinterpret_nth_f32_m128(a, 3);
+	double x = vreinterpret_m128d(__builtin_msa_splati_d(
+		vreinterpret_v2i64(a), 1))[0];
+	__builtin_memcpy(p, &x, sizeof(x));
+}
+
+/*
+ * Non-temporal accesses map onto MIPS `pref` hints. A streaming access
+ * that starts a cache line marks it load_streamed/store_streamed, so the
+ * line is filled into the LRU way and is the first to be evicted.
+ *
+ * With SSE2MSA_STREAM_LINE_BUFFER defined, streaming stores are instead
+ * gathered per thread into one cache line, shared by all translation
+ * units. A completely written line is written out in one go; a partial
+ * line is written with plain stores when the next line starts, on
+ * _mm_sfence() or on sse2msa_stream_flush(). Unlike x86, the streaming
+ * thread itself does not see buffered data: _mm_stream_load_si128 flushes
+ * first, but other loads from a line still being streamed need
+ * sse2msa_stream_flush(), and so does a thread about to exit.
+ *
+ * Defining SSE2MSA_STREAM_PREPARE_FOR_STORE as well asserts that
+ * SSE2MSA_CACHE_LINE is exactly the L1D line size of every core the
+ * program runs on, and a full line is then claimed with PrepareForStore
+ * (no read-for-ownership). PrepareForStore zeroes the whole hardware
+ * line, so a wrong size destroys live data. Every translation unit must
+ * see the same SSE2MSA_CACHE_LINE.
+ */
+#ifndef SSE2MSA_CACHE_LINE
+#define SSE2MSA_CACHE_LINE 64
+#endif
+
+#define v_msa_line_start(p) \
+	(((uintptr_t)(p) & (SSE2MSA_CACHE_LINE - 1)) == 0)
+
+#if defined(SSE2MSA_STREAM_LINE_BUFFER)
+#if SSE2MSA_CACHE_LINE < 32 || SSE2MSA_CACHE_LINE > 256
+#error SSE2MSA_CACHE_LINE must be between 32 and 256 bytes
+#endif
+
+/* `valid` has one bit per 32-bit word of the line */
+typedef struct sse2msa_stream_line {
+	uint8_t data[SSE2MSA_CACHE_LINE] ALIGN_STRUCT(16);
+	uintptr_t line;
+	uint64_t valid;
+} sse2msa_stream_line;
+
+SHARED_TLS sse2msa_stream_line sse2msa_stream_buf;
+
+#define v_msa_stream_full                                   \
+	(SSE2MSA_CACHE_LINE / 4 == 64 ? ~(uint64_t)0 :      \
+	((uint64_t)1 << SSE2MSA_CACHE_LINE / 4) - 1)
+
+FORCE_INLINE void sse2msa_stream_flush(void)
+{
+	uint8_t *dst = (uint8_t *)sse2msa_stream_buf.line;
+	uint64_t valid = sse2msa_stream_buf.valid;
+	for (int i = 0; valid; ++i, valid >>= 1)
+		if (valid & 1)
+			__builtin_memcpy(dst + 4 * i,
+				sse2msa_stream_buf.data + 4 * i, 4);
+	sse2msa_stream_buf.valid = 0;
+}
+
+FORCE_INLINE void v_msa_stream_commit(void)
+{
+	uint8_t *dst = (uint8_t *)sse2msa_stream_buf.line;
+#if defined(SSE2MSA_STREAM_PREPARE_FOR_STORE)
+	v_msa_prepare_for_store(dst);
+#endif
+	for (int i = 0; i < SSE2MSA_CACHE_LINE; i += 16)
+		__builtin_msa_st_b(__builtin_msa_ld_b(
+			sse2msa_stream_buf.data + i, 0), dst + i, 0);
+	sse2msa_stream_buf.valid = 0;
+}
+
+FORCE_INLINE void v_msa_stream_put(void *p, const void *src, int n)
+{
+	uintptr_t line = (uintptr_t)p & ~(uintptr_t)(SSE2MSA_CACHE_LINE - 1);
+	int off = (uintptr_t)p - line;
+	if ((off & 3) || off + n > SSE2MSA_CACHE_LINE) {
+		sse2msa_stream_flush();
+		__builtin_memcpy(p, src, n);
+		return;
+	}
+	if (line != sse2msa_stream_buf.line) {
+		sse2msa_stream_flush();
+		sse2msa_stream_buf.line = line;
+	}
+	__builtin_memcpy(sse2msa_stream_buf.data + off, src, n);
+	sse2msa_stream_buf.valid |= (((uint64_t)1 << n / 4) - 1) << off / 4;
+	if (sse2msa_stream_buf.valid == v_msa_stream_full)
+		v_msa_stream_commit();
+}
+
+/* flush when the line of `p` is the one being gathered */
+FORCE_INLINE void v_msa_stream_sync(const void *p)
+{
+	if (sse2msa_stream_buf.valid && sse2msa_stream_buf.line ==
+	    ((uintptr_t)p & ~(uintptr_t)(SSE2MSA_CACHE_LINE - 1)))
+		sse2msa_stream_flush();
+}
+#else
+FORCE_INLINE void sse2msa_stream_flush(void) {}
+
+FORCE_INLINE void v_msa_stream_sync(const void *p)
+{
+	(void)p;
 }
 
+FORCE_INLINE void v_msa_stream_hint(const void *p)
+{
+	if (v_msa_line_start(p))
+		v_msa_pref(SSE2MSA_PREF_STORE_STREAMED, p);
+}
+#endif
+
+/* `store` is the plain typed store of `a` to `p` */
+#if defined(SSE2MSA_STREAM_LINE_BUFFER)
+#define v_msa_stream(p, a, store) v_msa_stream_put(p, &(a), sizeof(a))
+#else
+#define v_msa_stream(p, a, store) \
+	do { v_msa_stream_hint(p); store; } while (0)
+#endif
+
 FORCE_INLINE __m128i _mm_stream_load_si128(__m128i *p)
 {
+	v_msa_stream_sync(p);
+	if (v_msa_line_start(p))
+		v_msa_pref(SSE2MSA_PREF_LOAD_STREAMED, p);
 	return vreinterpret_m128i(__builtin_msa_ld_d(p, 0));
 }
 
 FORCE_INLINE void _mm_stream_pd(double *p, __m128d a)
 {
-	__builtin_msa_st_d(vreinterpret_v2i64(a), p, 0);
+	v_msa_stream(p, a, __builtin_msa_st_d(vreinterpret_v2i64(a), p, 0));
 }
 
-FORCE_INLINE void _mm_stream_pi(__m64 *p, __m64 a) { *p = a; }
+FORCE_INLINE void _mm_stream_pi(__m64 *p, __m64 a)
+{
+	v_msa_stream(p, a, *p = a);
+}
 
 FORCE_INLINE void _mm_stream_ps(float *p, __m128 a)
 {
-	__builtin_msa_st_w(vreinterpret_v4i32(a), p, 0);	
+	v_msa_stream(p, a, __builtin_msa_st_w(vreinterpret_v4i32(a), p, 0));
 }
 
 FORCE_INLINE void _mm_stream_si128(__m128i *p, __m128i a)
 {
-	__builtin_msa_st_d(vreinterpret_v2i64(a), p, 0);
+	v_msa_stream(p, a, __builtin_msa_st_d(vreinterpret_v2i64(a), p, 0));
 }
 
-FORCE_INLINE void _mm_stream_si32(int *p, int a) { *p = a; }
+FORCE_INLINE void _mm_stream_si32(int *p, int a)
+{
+	v_msa_stream(p, a, *p = a);
+}
 
-FORCE_INLINE void _mm_stream_si64(int64_t *p, int64_t a) { *p = a; }
+FORCE_INLINE void _mm_stream_si64(int64_t *p, int64_t a)
+{
+	v_msa_stream(p, a, *p = a);
+}
 
 FORCE_INLINE __m128 _mm_load1_ps(const float *p)
 {
@@ -549,16 +740,14 @@ FORCE_INLINE __m128d _mm_load1_pd(const double *p)
 
 FORCE_INLINE __m128 _mm_loadl_pi(__m128 a, __m64 const *p)
 {
-	VREG128 v = {.m128 = a};
-	v.m64[0] = *p;
-	return v.m128;
+	return vreinterpret_m128(__builtin_msa_insert_d(
+		vreinterpret_v2i64(a), 0, vreinterpret_i64_m64(*p)));
 }
 
 FORCE_INLINE __m128 _mm_loadh_pi(__m128 a, __m64 const *p)
 {
-	VREG128 v = {.m128 = a};
-	v.m64[1] = *p;
-	return v.m128;
+	return vreinterpret_m128(__builtin_msa_insert_d(
+		vreinterpret_v2i64(a), 1, vreinterpret_i64_m64(*p)));
 }
 
 FORCE_INLINE __m128 _mm_load_ps(const float *p)
@@ -574,10 +763,8 @@ FORCE_INLINE __m128 _mm_loadr_ps(float const* p)
 
 FORCE_INLINE __m128d _mm_loadr_pd(const double *p)
 {
-	VREG128 v = {
-		.f64 = {p[1], p[0]}
-	};
-	return v.m128d;
+	return vreinterpret_m128d(__builtin_msa_shf_w(
+		__builtin_msa_ld_w(p, 0), 0x4e));
 }
 
 FORCE_INLINE __m128 _mm_loadu_ps(const float *p)
@@ -597,54 +784,60 @@ FORCE_INLINE __m128d _mm_loadu_pd(const double *p)
 
 FORCE_INLINE __m128d _mm_loadh_pd(__m128d a, const double *p)
 {
-	VREG128 v = {.m128d = a};
-	v.f64[1] = *p;
-	return v.m128d;
+	a[1] = *p;
+	return a;
 }
 
 FORCE_INLINE __m128d _mm_loadl_pd(__m128d a, const double *p)
 {
-	VREG128 v = {.m128d = a};
-	v.f64[0] = *p;
-	return v.m128d;
+	a[0] = *p;
+	return a;
 }
 
 FORCE_INLINE __m128d _mm_loaddup_pd(const double *p)
 {
-	VREG128 v = {.f64 = {*p, *p}};
-	return v.m128d;
+	return _mm_load1_pd(p);
 }
 
 FORCE_INLINE __m128 _mm_load_ss(const float *p)
 {
-	VREG128 v = {
-		.f32 = {*p, 0, 0, 0}
-	};
-	return v.m128;
+	return _mm_set_ss(*p);
 }
 
 FORCE_INLINE __m128d _mm_load_sd(double const *p)
 {
-	VREG128 v = {
-		.f64 = {*p, 0}
-	};
-	return v.m128d;
+	return _mm_set_sd(*p);
+}
+
+/*
+ * Partial loads land in lane 0 of a zeroed register; memcpy keeps unaligned
+ * `p` legal and lets the compiler pick lwc1/ldc1 or a GPR load + insert.
+ */
+FORCE_INLINE __m128i _mm_loadu_si16(const void *p)
+{
+	int16_t x;
+	__builtin_memcpy(&x, p, sizeof(x));
+	return vreinterpret_m128i(__builtin_msa_insert_h(
+		v_msa_setzero(v8i16), 0, x));
+}
+
+FORCE_INLINE __m128i _mm_loadu_si32(const void *p)
+{
+	float x;
+	__builtin_memcpy(&x, p, sizeof(x));
+	return vreinterpret_m128i(_mm_set_ss(x));
 }
 
 FORCE_INLINE __m128i _mm_loadu_si64(const void *p)
 {
-	VREG128 v = {
-		.i64 = {*(int64_t*)p, 0}
-	};
-	return v.m128i;
+	double x;
+	__builtin_memcpy(&x, p, sizeof(x));
+	return vreinterpret_m128i(_mm_set_sd(x));
 }
 
 FORCE_INLINE __m128i _mm_loadl_epi64(__m128i const *p)
 {
-	VREG128 v = {
-		.i64 = {vpreinterpret_nth_i64_m128d(p, 0), 0}
-	};
-	return v.m128i;
+	return _mm_loadu_si64(p);
 }
 
 FORCE_INLINE void *_mm_malloc(size_t size, size_t align)
@@ -664,18 +857,23 @@ FORCE_INLINE void _mm_free(void *addr)
 	free(addr);
 }
 
+/*
+ * The low lane of an MSA register aliases the FPU register of the same
+ * number, so exact lane-0 updates (loads, int32 to double) are written on
+ * a[0]. Rounding _ss/_sd ops stay a vector op plus insve: the scalar FPU
+ * rounds by FCSR, and the packed forms and _MM_SET_ROUNDING_MODE use
+ * MSACSR.
+ */
 FORCE_INLINE __m128 _mm_move_ss(__m128 a, __m128 b)
 {
-	VREG128 v = {.m128 = a};
-	v.f32[0] = vreinterpret_nth_f32_m128(b, 0);
-	return v.m128;
+	return vreinterpret_m128(__builtin_msa_insve_w(
+		vreinterpret_v4i32(a), 0, vreinterpret_v4i32(b)));
 }
 
 FORCE_INLINE __m128d _mm_move_sd(__m128d a, __m128d b)
 {
-	VREG128 v = {.m128d = a};
-	v.f64[0] = vreinterpret_nth_f64_m128d(b, 0);
-	return v.m128d;
+	return vreinterpret_m128d(__builtin_msa_insve_d(
+		vreinterpret_v2i64(a), 0, vreinterpret_v2i64(b)));
 }
 
 FORCE_INLINE __m128i _mm_move_epi64(__m128i a)
@@ -863,23 +1061,17 @@ FORCE_INLINE __m128i _mm_abs_epi8(__m128i a)
 
 FORCE_INLINE __m64 _mm_abs_pi32(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.m128i = _mm_abs_epi32(v.m128i);
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_abs_epi32(v_msa_fill_m64(__m128i, a)));
 }
 
 FORCE_INLINE __m64 _mm_abs_pi16(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.m128i = _mm_abs_epi16(v.m128i);
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_abs_epi16(v_msa_fill_m64(__m128i, a)));
 }
 
 FORCE_INLINE __m64 _mm_abs_pi8(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.m128i = _mm_abs_epi8(v.m128i);
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_abs_epi8(v_msa_fill_m64(__m128i, a)));
 }
 
 FORCE_INLINE __m128i _mm_sad_epu8(__m128i a, __m128i b)
@@ -896,16 +1088,71 @@ FORCE_INLINE __m128i _mm_sad_epu8(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_sad_pu8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_sad_epu8(va.m128i, vb.m128i)
-	};
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_sad_epu8(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
 }
 
 #define _m_psadbw(a, b) _mm_sad_pu8(a, b)
 
+/*
+ * Eight 4-byte SADs of a[ao + i .. ao + i + 3] against b[4 * bo ..]. The
+ * windows at ao and ao + 1 (ao + 2 and ao + 3) are interleaved so that
+ * every byte pair lines up with one splatted halfword of b, and a single
+ * hadd folds each pair. `ao` and `bo` must be literals.
+ */
+#define v_msa_mpsadbw(a, b, ao, bo)                                       \
+	({                                                                \
+		v16u8 _w0 = (v16u8)__builtin_msa_ilvr_b(                  \
+			__builtin_msa_sldi_b(a, a, (ao) + 1),             \
+			__builtin_msa_sldi_b(a, a, (ao)));                \
+		v16u8 _w1 = (v16u8)__builtin_msa_ilvr_b(                  \
+			__builtin_msa_sldi_b(a, a, (ao) + 3),             \
+			__builtin_msa_sldi_b(a, a, (ao) + 2));            \
+		v16u8 _d0 = __builtin_msa_asub_u_b(_w0, (v16u8)           \
+			__builtin_msa_splati_h((v8i16)(b), (bo) * 2));    \
+		v16u8 _d1 = __builtin_msa_asub_u_b(_w1, (v16u8)           \
+			__builtin_msa_splati_h((v8i16)(b), (bo) * 2 + 1)); \
+		__builtin_msa_hadd_u_h(_d0, _d0) +                        \
+			__builtin_msa_hadd_u_h(_d1, _d1);                 \
+	})
+
+#define _mm_mpsadbw_epu8_case(n)                                           \
+	case n:                                                            \
+		return vreinterpret_m128i(v_msa_mpsadbw(v, u,              \
+			((n) >> 2) * 4, (n) & 3));
+
+FORCE_INLINE __m128i _mm_mpsadbw_epu8(__m128i a, __m128i b, const int imm8)
+{
+	v16i8 v = vreinterpret_v16i8(a);
+	v16i8 u = vreinterpret_v16i8(b);
+	switch (imm8 & 7) {
+	_mm_mpsadbw_epu8_case(0)
+	_mm_mpsadbw_epu8_case(1)
+	_mm_mpsadbw_epu8_case(2)
+	_mm_mpsadbw_epu8_case(3)
+	_mm_mpsadbw_epu8_case(4)
+	_mm_mpsadbw_epu8_case(5)
+	_mm_mpsadbw_epu8_case(6)
+	_mm_mpsadbw_epu8_case(7)
+	}
+	return v_msa_setzero(__m128i);
+}
+
+/*
+ * SADs of the 16-byte row `cur` against ref[i .. i + 15] for i = 0..7,
+ * i.e. one row of a 16-wide block at eight horizontal candidates. Reads
+ * 24 bytes at ref; same result as four _mm_mpsadbw_epu8 summed.
+ */
+FORCE_INLINE __m128i sse2msa_mpsadbw_row_epu8(const void *ref, __m128i cur)
+{
+	v16i8 lo = __builtin_msa_ld_b(ref, 0);
+	v16i8 hi = __builtin_msa_ld_b(ref, 8);
+	v16i8 c = vreinterpret_v16i8(cur);
+	return vreinterpret_m128i(
+		v_msa_mpsadbw(lo, c, 0, 0) + v_msa_mpsadbw(lo, c, 4, 1) +
+		v_msa_mpsadbw(hi, c, 0, 2) + v_msa_mpsadbw(hi, c, 4, 3));
+}
+
 FORCE_INLINE __m128 _mm_shuffle_ps(__m128 a, __m128 b, int imm8)
 {
 	return vreinterpret_m128(__builtin_msa_vshf_w(
@@ -934,26 +1181,15 @@ FORCE_INLINE __m128i _mm_shuffle_epi8(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_shuffle_pi8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	v16i8 mask = vreinterpret_v16i8((vb.msa_v16u8 << 5) >> 5);
-	mask = mask | (vb.msa_v16i8 & __builtin_msa_fill_b(0x80));
-	VREG128 v = {
-		.msa_v16i8 = __builtin_msa_vshf_b(
-			mask, va.msa_v16i8, va.msa_v16i8)
-	};
-	return v.m64[0];
+	v16i8 va = v_msa_fill_m64(v16i8, a);
+	v16u8 vb = v_msa_fill_m64(v16u8, b);
+	v16i8 mask = vreinterpret_v16i8(__builtin_msa_andi_b(vb, 0x87));
+	return v_msa_copy_m64(__builtin_msa_vshf_b(mask, va, va));
 }
 
-FORCE_INLINE __m64 _mm_shuffle_pi16(__m64 a, int imm8)
-{
-	VREG128 v = {.m64 = {a, a}};
-	v.msa_v8i16 = __builtin_msa_vshf_h(
-		({v8i16 mask = {(imm8) & (0x3), ((imm8) >> 2) & 0x3,
-		(((imm8) >> 4) & 0x3) + 4, (((imm8) >> 6) & 0x3) + 4,
-		0, 0, 0, 0}; mask;}), v.msa_v8i16, v.msa_v8i16);
-	return v.m64[0];
-}
+/* `shf.h` permutes each group of 4 halfwords, which is exactly `pshufw` */
+#define _mm_shuffle_pi16(a, imm8) \
+	v_msa_copy_m64(__builtin_msa_shf_h(v_msa_fill_m64(v8i16, a), imm8))
 
 #define _m_pshufw(a, imm) _mm_shuffle_pi16(a, imm)
 
@@ -1413,19 +1649,87 @@ FORCE_INLINE int _mm_movemask_epi8(__m128i a)
 
 FORCE_INLINE int _mm_movemask_pi8(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v8u16 s = vreinterpret_v8u16(__builtin_msa_srli_b(v.msa_v16i8, 7));
+	v16i8 v = v_msa_fill_m64(v16i8, a);
+	v8u16 s = vreinterpret_v8u16(__builtin_msa_srli_b(v, 7));
 	v4u32 p16 = vreinterpret_v4u32((vreinterpret_v8u16(
 		__builtin_msa_srli_h(vreinterpret_v8i16(s), 7))) + s);
 	v2u64 p32 = vreinterpret_v2u64((vreinterpret_v4u32(
 		__builtin_msa_srli_w(vreinterpret_v4i32(p16), 14))) + p16);
-	v.msa_v2u64 = (vreinterpret_v2u64(
+	v2u64 p64 = (vreinterpret_v2u64(
 		__builtin_msa_srli_d((v2i64)p32, 28))) + p32;
-	return v.u8[0];
+	return __builtin_msa_copy_u_b(vreinterpret_v16i8(p64), 0);
 }
 
 #define _m_pmovmskb(a) _mm_movemask_pi8(a)
 
+/*
+ * Byte-masked stores. When any byte is stored and all of the vector lies
+ * in one page, the whole vector is known to be writable and the store is
+ * a load/bsel/store (or a plain store for a full mask). Otherwise only
+ * the selected bytes are touched, so a mask that ends at the end of a
+ * buffer never faults past it. Unlike x86 the fast path rewrites the
+ * unselected bytes with their old values; do not race other writers on
+ * the same 16 bytes.
+ */
+#ifndef SSE2MSA_PAGE_SIZE
+#define SSE2MSA_PAGE_SIZE 4096
+#endif
+
+#define v_msa_same_page(p, n) \
+	(((uintptr_t)(p) & (SSE2MSA_PAGE_SIZE - 1)) <= SSE2MSA_PAGE_SIZE - (n))
+
+FORCE_INLINE void v_msa_maskmov_bytes(char *p, const char *src,
+				      unsigned int bits)
+{
+	for (; bits; bits &= bits - 1)
+		p[__builtin_ctz(bits)] = src[__builtin_ctz(bits)];
+}
+
+FORCE_INLINE void _mm_maskmoveu_si128(__m128i a, __m128i mask, char *p)
+{
+	int bits = _mm_movemask_epi8(mask);
+	v16i8 sel;
+	char src[16];
+
+	if (!bits)
+		return;
+	sse2msa_stream_flush();
+	if (bits == 0xffff) {
+		__builtin_msa_st_b(vreinterpret_v16i8(a), p, 0);
+	} else if (v_msa_same_page(p, 16)) {
+		sel = __builtin_msa_clti_s_b(vreinterpret_v16i8(mask), 0);
+		__builtin_msa_st_b((v16i8)__builtin_msa_bsel_v((v16u8)sel,
+			(v16u8)__builtin_msa_ld_b(p, 0),
+			vreinterpret_v16u8(a)), p, 0);
+	} else {
+		__builtin_msa_st_b(vreinterpret_v16i8(a), src, 0);
+		v_msa_maskmov_bytes(p, src, bits);
+	}
+}
+
+FORCE_INLINE void _mm_maskmove_si64(__m64 a, __m64 mask, char *p)
+{
+	uint64_t m = vreinterpret_i64_m64(mask);
+	uint64_t v = vreinterpret_i64_m64(a);
+	uint64_t old;
+
+	/* bit 7 of each byte to the whole byte, in any byte order */
+	m = ((m >> 7) & 0x0101010101010101ull) * 0xff;
+	if (!m)
+		return;
+	sse2msa_stream_flush();
+	if (v_msa_same_page(p, 8)) {
+		__builtin_memcpy(&old, p, sizeof(old));
+		v = (old & ~m) | (v & m);
+		__builtin_memcpy(p, &v, sizeof(v));
+	} else {
+		v_msa_maskmov_bytes(p, (const char *)&v,
+			_mm_movemask_pi8(mask));
+	}
+}
+
+#define _m_maskmovq(a, mask, p) _mm_maskmove_si64(a, mask, p)
+
 FORCE_INLINE int _mm_movemask_ps(__m128 a)
 {
 	VREG128 v = {.m128 = a};
@@ -1445,730 +1749,2512 @@ FORCE_INLINE int _mm_movemask_pd(__m128d a)
 
 FORCE_INLINE __m128i _mm_movpi64_epi64(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	return v.m128i;
+	return vreinterpret_m128i(__builtin_msa_insert_d(
+		v_msa_setzero(v2i64), 0, vreinterpret_i64_m64(a)));
 }
 
 FORCE_INLINE __m64 _mm_movepi64_pi64(__m128i a)
 {
-	VREG128 v = {.m128i = a};
-	return v.m64[0];
+	return v_msa_copy_m64(a);
 }
 
-FORCE_INLINE int _mm_test_all_ones(__m128i a)
+/* Ref: mmintrin.h
+ * Moves, logic and 64-bit shifts stay in the `__m64` register; lane-wise
+ * arithmetic goes through lane 0 of a MSA register (see v_msa_fill_m64).
+ * There is no x87 state to hand back, so _mm_empty() is a no-op.
+ */
+#define v_msa_m64_op(op, type, a, b) \
+	v_msa_copy_m64(op(v_msa_fill_m64(type, a), v_msa_fill_m64(type, b)))
+
+/* high half of the interleave of both low halves */
+#define v_msa_m64_unpackhi(op, type, a, b)                                \
+	vreinterpret_m64_i64(__builtin_msa_copy_s_d(vreinterpret_v2i64(   \
+		op(v_msa_fill_m64(type, b), v_msa_fill_m64(type, a))), 1))
+
+FORCE_INLINE void _mm_empty(void)
 {
-	return (vreinterpret_nth_i64_m128i(a, 0) &
-		vreinterpret_nth_i64_m128i(a, 1)) == ~(int64_t)0;
 }
 
-FORCE_INLINE int _mm_test_all_zeros(__m128i a, __m128i mask)
+FORCE_INLINE __m64 _mm_setzero_si64(void)
 {
-	VREG128 v = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
-	};
-	return (v.i64[0] | v.i64[1]) ? 0 : 1;
+	return vreinterpret_m64_i64(0);
 }
 
-FORCE_INLINE int _mm_testc_si128(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cvtsi32_si64(int a)
 {
-	VREG128 v = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			~vreinterpret_v16u8(a), vreinterpret_v16u8(b))
-	};
-	return (v.i64[0] | v.i64[1]) ? 0 : 1;
+	return (__m64)(v2i32){a, 0};
 }
 
-FORCE_INLINE int _mm_testz_si128(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cvtsi64_si32(__m64 a)
 {
-	VREG128 v = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			vreinterpret_v16u8(a), vreinterpret_v16u8(b))
-	};
-	return (v.i64[0] | v.i64[1]) ? 0 : 1;
+	return a[0];
 }
 
-FORCE_INLINE int _mm_testnzc_si128(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cvtsi64_m64(int64_t a)
 {
-	VREG128 vz = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			vreinterpret_v16u8(a), vreinterpret_v16u8(b))
-	};
-	VREG128 vc = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			~vreinterpret_v16u8(a), vreinterpret_v16u8(b))
-	};
-	return (vz.i64[0] | vz.i64[1]) && (vc.i64[0] | vc.i64[1]) ? 1 : 0;
+	return vreinterpret_m64_i64(a);
 }
 
-FORCE_INLINE int _mm_test_mix_ones_zeros(__m128i a, __m128i mask)
+FORCE_INLINE int64_t _mm_cvtm64_si64(__m64 a)
 {
-	VREG128 vz = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
-	};
-	VREG128 vc = {
-		.msa_v16u8 = __builtin_msa_and_v(
-			~vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
-	};
-	return (vz.i64[0] | vz.i64[1]) && (vc.i64[0] | vc.i64[1]) ? 1 : 0;
+	return vreinterpret_i64_m64(a);
 }
 
-FORCE_INLINE __m128 _mm_sub_ps(__m128 a, __m128 b)
+#define _mm_cvtsi64x_si64(a) _mm_cvtsi64_m64(a)
+#define _mm_set_pi64x(a) _mm_cvtsi64_m64(a)
+#define _mm_cvtsi64_si64x(a) _mm_cvtm64_si64(a)
+
+FORCE_INLINE __m64 _mm_set_pi32(int e1, int e0)
 {
-	return vreinterpret_m128(__builtin_msa_fsub_w(
-		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+	return (__m64)(v2i32){e0, e1};
 }
 
-FORCE_INLINE __m128 _mm_sub_ss(__m128 a, __m128 b)
+FORCE_INLINE __m64 _mm_set_pi16(short e3, short e2, short e1, short e0)
 {
-	return _mm_move_ss(a, _mm_sub_ps(a, b));
+	return (__m64)(v4i16){e0, e1, e2, e3};
 }
 
-FORCE_INLINE __m128d _mm_sub_pd(__m128d a, __m128d b)
+FORCE_INLINE __m64 _mm_set_pi8(char e7, char e6, char e5, char e4,
+			       char e3, char e2, char e1, char e0)
 {
-	return vreinterpret_m128d(__builtin_msa_fsub_d(
-		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+	return (__m64)(v8i8){e0, e1, e2, e3, e4, e5, e6, e7};
 }
 
-FORCE_INLINE __m128d _mm_sub_sd(__m128d a, __m128d b)
+FORCE_INLINE __m64 _mm_setr_pi32(int e0, int e1)
 {
-	return _mm_move_sd(a, _mm_sub_pd(a, b));
+	return _mm_set_pi32(e1, e0);
 }
 
-FORCE_INLINE __m128i _mm_sub_epi64(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_setr_pi16(short e0, short e1, short e2, short e3)
 {
-	return vreinterpret_m128i(__builtin_msa_subv_d(
-		vreinterpret_v2i64(a), vreinterpret_v2i64(b)));
+	return _mm_set_pi16(e3, e2, e1, e0);
 }
 
-FORCE_INLINE __m128i _mm_sub_epi32(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_setr_pi8(char e0, char e1, char e2, char e3,
+				char e4, char e5, char e6, char e7)
 {
-	return vreinterpret_m128i(__builtin_msa_subv_w(
-		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+	return _mm_set_pi8(e7, e6, e5, e4, e3, e2, e1, e0);
 }
 
-FORCE_INLINE __m128i _mm_sub_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_set1_pi32(int a)
 {
-	return vreinterpret_m128i(__builtin_msa_subv_h(
-		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+	return _mm_set_pi32(a, a);
 }
 
-FORCE_INLINE __m128i _mm_sub_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_set1_pi16(short a)
 {
-	return vreinterpret_m128i(__builtin_msa_subv_b(
-		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+	return _mm_set_pi16(a, a, a, a);
 }
 
-FORCE_INLINE __m64 _mm_sub_si64(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_set1_pi8(char a)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.i64[0] -= v.i64[1]; 
-	return v.m64[0];
+	return _mm_set_pi8(a, a, a, a, a, a, a, a);
 }
 
-FORCE_INLINE __m128i _mm_subs_epu16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_and_si64(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_subs_u_h(
-		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+	return vreinterpret_m64_i64(
+		vreinterpret_i64_m64(a) & vreinterpret_i64_m64(b));
 }
 
-FORCE_INLINE __m128i _mm_subs_epu8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_andnot_si64(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_subs_u_b(
-		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+	return vreinterpret_m64_i64(
+		~vreinterpret_i64_m64(a) & vreinterpret_i64_m64(b));
 }
 
-FORCE_INLINE __m128i _mm_subs_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_or_si64(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_subs_s_b(
-		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+	return vreinterpret_m64_i64(
+		vreinterpret_i64_m64(a) | vreinterpret_i64_m64(b));
 }
 
-FORCE_INLINE __m128i _mm_subs_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_xor_si64(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_subs_s_h(
-		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+	return vreinterpret_m64_i64(
+		vreinterpret_i64_m64(a) ^ vreinterpret_i64_m64(b));
 }
 
-FORCE_INLINE __m128i _mm_adds_epu16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_add_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_adds_u_h(
-		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+	return v_msa_m64_op(__builtin_msa_addv_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m128i _mm_adds_epu8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_add_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_adds_u_b(
-		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+	return v_msa_m64_op(__builtin_msa_addv_h, v8i16, a, b);
 }
 
-FORCE_INLINE __m128i _mm_adds_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_add_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_adds_s_b(
-		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+	return v_msa_m64_op(__builtin_msa_addv_w, v4i32, a, b);
 }
 
-FORCE_INLINE __m128i _mm_adds_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_adds_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_adds_s_h(
-		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+	return v_msa_m64_op(__builtin_msa_adds_s_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m64 _mm_avg_pu16(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_adds_pi16(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v  = {
-		.msa_v8u16 = __builtin_msa_aver_u_h(
-			va.msa_v8u16, vb.msa_v8u16)
-	};
-	return v.m64[0];
+	return v_msa_m64_op(__builtin_msa_adds_s_h, v8i16, a, b);
 }
 
-#define _m_pavgw(a, b) _mm_avg_pu16(a, b)
-
-FORCE_INLINE __m64 _mm_avg_pu8(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_adds_pu8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v  = {
-		.msa_v16u8 = __builtin_msa_aver_u_b(
-			va.msa_v16u8, vb.msa_v16u8)
-	};
-	return v.m64[0];
+	return v_msa_m64_op(__builtin_msa_adds_u_b, v16u8, a, b);
 }
 
-#define _m_pavgb(a, b) _mm_avg_pu8(a, b)
+FORCE_INLINE __m64 _mm_adds_pu16(__m64 a, __m64 b)
+{
+	return v_msa_m64_op(__builtin_msa_adds_u_h, v8u16, a, b);
+}
 
-FORCE_INLINE __m128i _mm_avg_epu16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_sub_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_aver_u_h(
-		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+	return v_msa_m64_op(__builtin_msa_subv_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m128i _mm_avg_epu8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_sub_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_aver_u_b(
-		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+	return v_msa_m64_op(__builtin_msa_subv_h, v8i16, a, b);
 }
 
-FORCE_INLINE __m128 _mm_add_ps(__m128 a, __m128 b)
+FORCE_INLINE __m64 _mm_sub_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128(__builtin_msa_fadd_w(
-		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+	return v_msa_m64_op(__builtin_msa_subv_w, v4i32, a, b);
 }
 
-FORCE_INLINE __m128d _mm_add_pd(__m128d a, __m128d b)
+FORCE_INLINE __m64 _mm_subs_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128d(__builtin_msa_fadd_d(
-		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+	return v_msa_m64_op(__builtin_msa_subs_s_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m128d _mm_add_sd(__m128d a, __m128d b)
+FORCE_INLINE __m64 _mm_subs_pi16(__m64 a, __m64 b)
 {
-	return _mm_move_sd(a, _mm_add_pd(a, b));
+	return v_msa_m64_op(__builtin_msa_subs_s_h, v8i16, a, b);
 }
 
-FORCE_INLINE __m64 _mm_add_si64(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_subs_pu8(__m64 a, __m64 b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.i64[0] += v.i64[1]; 
-	return v.m64[0];
+	return v_msa_m64_op(__builtin_msa_subs_u_b, v16u8, a, b);
 }
 
-FORCE_INLINE __m128 _mm_add_ss(__m128 a, __m128 b)
+FORCE_INLINE __m64 _mm_subs_pu16(__m64 a, __m64 b)
 {
-	return _mm_move_ss(a, _mm_add_ps(a, b));
+	return v_msa_m64_op(__builtin_msa_subs_u_h, v8u16, a, b);
 }
 
-FORCE_INLINE __m128i _mm_add_epi64(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_madd_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_addv_d(
-		vreinterpret_v2i64(a), vreinterpret_v2i64(b)));
+	return v_msa_m64_op(__builtin_msa_dotp_s_w, v8i16, a, b);
 }
 
-FORCE_INLINE __m128i _mm_add_epi32(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cmpeq_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_addv_w(
-		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+	return v_msa_m64_op(__builtin_msa_ceq_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m128i _mm_add_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cmpeq_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_addv_h(
-		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+	return v_msa_m64_op(__builtin_msa_ceq_h, v8i16, a, b);
 }
 
-FORCE_INLINE __m128i _mm_add_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cmpeq_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_addv_b(
-		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+	return v_msa_m64_op(__builtin_msa_ceq_w, v4i32, a, b);
 }
 
-FORCE_INLINE __m128 _mm_hadd_ps(__m128 a, __m128 b)
+FORCE_INLINE __m64 _mm_cmpgt_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128(vreinterpret_v4f32(
-		__builtin_msa_vshf_w(({v4i32 m = {0, 2, 4, 6}; m;}),
-		vreinterpret_v4i32(b),vreinterpret_v4i32(a))) +
-		vreinterpret_v4f32(
-		__builtin_msa_vshf_w(({v4i32 m = {1, 3, 5, 7}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a))));
+	return v_msa_m64_op(__builtin_msa_clt_s_b, v16i8, b, a);
 }
 
-FORCE_INLINE __m128d _mm_hadd_pd(__m128d a, __m128d b)
+FORCE_INLINE __m64 _mm_cmpgt_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128d(vreinterpret_v2f64(
-		__builtin_msa_vshf_d(({v2i64 m = {0, 2}; m;}),
-		vreinterpret_v2i64(b), vreinterpret_v2i64(a))) +
-		vreinterpret_v2f64(
-		__builtin_msa_vshf_d(({v2i64 m = {1, 3}; m;}),
-		vreinterpret_v2i64(b), vreinterpret_v2i64(a))));
+	return v_msa_m64_op(__builtin_msa_clt_s_h, v8i16, b, a);
 }
 
-FORCE_INLINE __m128i _mm_hadd_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_cmpgt_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_vshf_h(
-		({v8i16 m = {0, 2, 4, 6, 8, 10, 12, 14}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)) +
-		__builtin_msa_vshf_h(
-		({v8i16 m = {1, 3, 5, 7, 9, 11, 13, 15}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)));
+	return v_msa_m64_op(__builtin_msa_clt_s_w, v4i32, b, a);
 }
 
-FORCE_INLINE __m128i _mm_hadd_epi32(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_unpacklo_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(
-		__builtin_msa_vshf_w(({v4i32 m = {0, 2, 4, 6}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a)) +
-		__builtin_msa_vshf_w(({v4i32 m = {1, 3, 5, 7}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a)));
+	return v_msa_m64_op(__builtin_msa_ilvr_b, v16i8, b, a);
 }
 
-FORCE_INLINE __m64 _mm_hadd_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_unpacklo_pi16(__m64 a, __m64 b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.m128i = _mm_hadd_epi16(v.m128i, v.m128i);
-	return v.m64[0];
+	return v_msa_m64_op(__builtin_msa_ilvr_h, v8i16, b, a);
 }
 
-FORCE_INLINE __m64 _mm_hadd_pi32(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_unpacklo_pi32(__m64 a, __m64 b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.m128i = _mm_hadd_epi32(v.m128i, v.m128i);
-	return v.m64[0];
+	return (__m64)(v2i32){a[0], b[0]};
 }
 
-FORCE_INLINE __m128i _mm_hadds_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_unpackhi_pi8(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(
-		__builtin_msa_adds_s_h(__builtin_msa_vshf_h(
-		({v8i16 m = {0, 2, 4, 6, 8, 10, 12, 14}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
-		__builtin_msa_vshf_h(
-		({v8i16 m = {1, 3, 5, 7, 9, 11, 13, 15}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+	return v_msa_m64_unpackhi(__builtin_msa_ilvr_b, v16i8, a, b);
 }
 
-FORCE_INLINE __m64 _mm_hadds_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m64 _mm_unpackhi_pi16(__m64 a, __m64 b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.m128i = _mm_hadds_epi16(v.m128i, v.m128i);
-	return v.m64[0];
+	return v_msa_m64_unpackhi(__builtin_msa_ilvr_h, v8i16, a, b);
 }
 
-FORCE_INLINE __m128 _mm_hsub_ps(__m128 a, __m128 b)
+FORCE_INLINE __m64 _mm_unpackhi_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128(vreinterpret_v4f32(
-		__builtin_msa_vshf_w(({v4i32 m = {0, 2, 4, 6}; m;}),
-		vreinterpret_v4i32(b),vreinterpret_v4i32(a))) -
-		vreinterpret_v4f32(
-		__builtin_msa_vshf_w(({v4i32 m = {1, 3, 5, 7}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a))));
+	return (__m64)(v2i32){a[1], b[1]};
 }
 
-FORCE_INLINE __m128d _mm_hsub_pd(__m128d a, __m128d b)
+/* a in lane 0 and b in lane 1, saturate, then keep the even halves */
+FORCE_INLINE __m64 _mm_packs_pi16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128d(vreinterpret_v2f64(
-		__builtin_msa_vshf_d(({v2i64 m = {0, 2}; m;}),
-		vreinterpret_v2i64(b), vreinterpret_v2i64(a))) -
-		vreinterpret_v2f64(
-		__builtin_msa_vshf_d(({v2i64 m = {1, 3}; m;}),
-		vreinterpret_v2i64(b), vreinterpret_v2i64(a))));
+	v16i8 v = vreinterpret_v16i8(__builtin_msa_sat_s_h(
+		v_msa_pack_m64(v8i16, a, b), 7));
+	return v_msa_copy_m64(__builtin_msa_pckev_b(v, v));
 }
 
-FORCE_INLINE __m128i _mm_hsub_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_packs_pi32(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(__builtin_msa_vshf_h(
-		({v8i16 m = {0, 2, 4, 6, 8, 10, 12, 14}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)) -
-		__builtin_msa_vshf_h(
-		({v8i16 m = {1, 3, 5, 7, 9, 11, 13, 15}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)));
+	v8i16 v = vreinterpret_v8i16(__builtin_msa_sat_s_w(
+		v_msa_pack_m64(v4i32, a, b), 15));
+	return v_msa_copy_m64(__builtin_msa_pckev_h(v, v));
 }
 
-FORCE_INLINE __m128i _mm_hsub_epi32(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_packs_pu16(__m64 a, __m64 b)
 {
-	return vreinterpret_m128i(
-		__builtin_msa_vshf_w(({v4i32 m = {0, 2, 4, 6}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a)) -
-		__builtin_msa_vshf_w(({v4i32 m = {1, 3, 5, 7}; m;}),
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a)));
+	v16i8 v = vreinterpret_v16i8(__builtin_msa_sat_u_h(vreinterpret_v8u16(
+		__builtin_msa_maxi_s_h(v_msa_pack_m64(v8i16, a, b), 0)), 7));
+	return v_msa_copy_m64(__builtin_msa_pckev_b(v, v));
 }
 
-FORCE_INLINE __m64 _mm_hsub_pi16(__m64 a, __m64 b)
+/* Counts above the lane width clear the lane (logical) or fill it with
+ * the sign (arithmetic), as on x86.
+ */
+FORCE_INLINE __m64 _mm_slli_pi16(__m64 a, int n)
+{
+	if ((unsigned int)n > 15)
+		return _mm_setzero_si64();
+	return v_msa_copy_m64(__builtin_msa_sll_h(
+		v_msa_fill_m64(v8i16, a), __builtin_msa_fill_h(n)));
+}
+
+FORCE_INLINE __m64 _mm_slli_pi32(__m64 a, int n)
+{
+	if ((unsigned int)n > 31)
+		return _mm_setzero_si64();
+	return v_msa_copy_m64(__builtin_msa_sll_w(
+		v_msa_fill_m64(v4i32, a), __builtin_msa_fill_w(n)));
+}
+
+FORCE_INLINE __m64 _mm_slli_si64(__m64 a, int n)
+{
+	if ((unsigned int)n > 63)
+		return _mm_setzero_si64();
+	return vreinterpret_m64_i64((uint64_t)vreinterpret_i64_m64(a) << n);
+}
+
+FORCE_INLINE __m64 _mm_srli_pi16(__m64 a, int n)
+{
+	if ((unsigned int)n > 15)
+		return _mm_setzero_si64();
+	return v_msa_copy_m64(__builtin_msa_srl_h(
+		v_msa_fill_m64(v8i16, a), __builtin_msa_fill_h(n)));
+}
+
+FORCE_INLINE __m64 _mm_srli_pi32(__m64 a, int n)
+{
+	if ((unsigned int)n > 31)
+		return _mm_setzero_si64();
+	return v_msa_copy_m64(__builtin_msa_srl_w(
+		v_msa_fill_m64(v4i32, a), __builtin_msa_fill_w(n)));
+}
+
+FORCE_INLINE __m64 _mm_srli_si64(__m64 a, int n)
+{
+	if ((unsigned int)n > 63)
+		return _mm_setzero_si64();
+	return vreinterpret_m64_i64((uint64_t)vreinterpret_i64_m64(a) >> n);
+}
+
+FORCE_INLINE __m64 _mm_srai_pi16(__m64 a, int n)
+{
+	if ((unsigned int)n > 15)
+		n = 15;
+	return v_msa_copy_m64(__builtin_msa_sra_h(
+		v_msa_fill_m64(v8i16, a), __builtin_msa_fill_h(n)));
+}
+
+FORCE_INLINE __m64 _mm_srai_pi32(__m64 a, int n)
+{
+	if ((unsigned int)n > 31)
+		n = 31;
+	return v_msa_copy_m64(__builtin_msa_sra_w(
+		v_msa_fill_m64(v4i32, a), __builtin_msa_fill_w(n)));
+}
+
+/* The count is the whole 64-bit operand */
+#define v_msa_m64_count(count) \
+	((uint64_t)vreinterpret_i64_m64(count) > 64 ? 64 : \
+	 (int)vreinterpret_i64_m64(count))
+
+FORCE_INLINE __m64 _mm_sll_pi16(__m64 a, __m64 count)
+{
+	return _mm_slli_pi16(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_sll_pi32(__m64 a, __m64 count)
+{
+	return _mm_slli_pi32(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_sll_si64(__m64 a, __m64 count)
+{
+	return _mm_slli_si64(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_srl_pi16(__m64 a, __m64 count)
+{
+	return _mm_srli_pi16(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_srl_pi32(__m64 a, __m64 count)
+{
+	return _mm_srli_pi32(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_srl_si64(__m64 a, __m64 count)
+{
+	return _mm_srli_si64(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_sra_pi16(__m64 a, __m64 count)
+{
+	return _mm_srai_pi16(a, v_msa_m64_count(count));
+}
+
+FORCE_INLINE __m64 _mm_sra_pi32(__m64 a, __m64 count)
+{
+	return _mm_srai_pi32(a, v_msa_m64_count(count));
+}
+
+#define _m_empty() _mm_empty()
+#define _m_from_int(a) _mm_cvtsi32_si64(a)
+#define _m_from_int64(a) _mm_cvtsi64_m64(a)
+#define _m_to_int(a) _mm_cvtsi64_si32(a)
+#define _m_to_int64(a) _mm_cvtm64_si64(a)
+#define _m_packsswb(a, b) _mm_packs_pi16(a, b)
+#define _m_packssdw(a, b) _mm_packs_pi32(a, b)
+#define _m_packuswb(a, b) _mm_packs_pu16(a, b)
+#define _m_punpckhbw(a, b) _mm_unpackhi_pi8(a, b)
+#define _m_punpckhwd(a, b) _mm_unpackhi_pi16(a, b)
+#define _m_punpckhdq(a, b) _mm_unpackhi_pi32(a, b)
+#define _m_punpcklbw(a, b) _mm_unpacklo_pi8(a, b)
+#define _m_punpcklwd(a, b) _mm_unpacklo_pi16(a, b)
+#define _m_punpckldq(a, b) _mm_unpacklo_pi32(a, b)
+#define _m_paddb(a, b) _mm_add_pi8(a, b)
+#define _m_paddw(a, b) _mm_add_pi16(a, b)
+#define _m_paddd(a, b) _mm_add_pi32(a, b)
+#define _m_paddsb(a, b) _mm_adds_pi8(a, b)
+#define _m_paddsw(a, b) _mm_adds_pi16(a, b)
+#define _m_paddusb(a, b) _mm_adds_pu8(a, b)
+#define _m_paddusw(a, b) _mm_adds_pu16(a, b)
+#define _m_psubb(a, b) _mm_sub_pi8(a, b)
+#define _m_psubw(a, b) _mm_sub_pi16(a, b)
+#define _m_psubd(a, b) _mm_sub_pi32(a, b)
+#define _m_psubsb(a, b) _mm_subs_pi8(a, b)
+#define _m_psubsw(a, b) _mm_subs_pi16(a, b)
+#define _m_psubusb(a, b) _mm_subs_pu8(a, b)
+#define _m_psubusw(a, b) _mm_subs_pu16(a, b)
+#define _m_pmaddwd(a, b) _mm_madd_pi16(a, b)
+#define _m_pcmpeqb(a, b) _mm_cmpeq_pi8(a, b)
+#define _m_pcmpeqw(a, b) _mm_cmpeq_pi16(a, b)
+#define _m_pcmpeqd(a, b) _mm_cmpeq_pi32(a, b)
+#define _m_pcmpgtb(a, b) _mm_cmpgt_pi8(a, b)
+#define _m_pcmpgtw(a, b) _mm_cmpgt_pi16(a, b)
+#define _m_pcmpgtd(a, b) _mm_cmpgt_pi32(a, b)
+#define _m_pand(a, b) _mm_and_si64(a, b)
+#define _m_pandn(a, b) _mm_andnot_si64(a, b)
+#define _m_por(a, b) _mm_or_si64(a, b)
+#define _m_pxor(a, b) _mm_xor_si64(a, b)
+#define _m_psllw(a, c) _mm_sll_pi16(a, c)
+#define _m_psllwi(a, n) _mm_slli_pi16(a, n)
+#define _m_pslld(a, c) _mm_sll_pi32(a, c)
+#define _m_pslldi(a, n) _mm_slli_pi32(a, n)
+#define _m_psllq(a, c) _mm_sll_si64(a, c)
+#define _m_psllqi(a, n) _mm_slli_si64(a, n)
+#define _m_psrlw(a, c) _mm_srl_pi16(a, c)
+#define _m_psrlwi(a, n) _mm_srli_pi16(a, n)
+#define _m_psrld(a, c) _mm_srl_pi32(a, c)
+#define _m_psrldi(a, n) _mm_srli_pi32(a, n)
+#define _m_psrlq(a, c) _mm_srl_si64(a, c)
+#define _m_psrlqi(a, n) _mm_srli_si64(a, n)
+#define _m_psraw(a, c) _mm_sra_pi16(a, c)
+#define _m_psrawi(a, n) _mm_srai_pi16(a, n)
+#define _m_psrad(a, c) _mm_sra_pi32(a, c)
+#define _m_psradi(a, n) _mm_srai_pi32(a, n)
+#define _m_pmullw(a, b) _mm_mullo_pi16(a, b)
+#define _m_pmulhw(a, b) _mm_mulhi_pi16(a, b)
+
+FORCE_INLINE int _mm_test_all_ones(__m128i a)
+{
+	return (vreinterpret_nth_i64_m128i(a, 0) &
+		vreinterpret_nth_i64_m128i(a, 1)) == ~(int64_t)0;
+}
+
+FORCE_INLINE int _mm_test_all_zeros(__m128i a, __m128i mask)
 {
 	VREG128 v = {
-		.m64 = {a, b}
+		.msa_v16u8 = __builtin_msa_and_v(
+			vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
 	};
-	v.m128i = _mm_hsub_epi16(v.m128i, v.m128i);
-	return v.m64[0];
+	return (v.i64[0] | v.i64[1]) ? 0 : 1;
 }
 
-FORCE_INLINE __m64 _mm_hsub_pi32(__m64 a, __m64 b)
+FORCE_INLINE int _mm_testc_si128(__m128i a, __m128i b)
 {
 	VREG128 v = {
-		.m64 = {a, b}
+		.msa_v16u8 = __builtin_msa_and_v(
+			~vreinterpret_v16u8(a), vreinterpret_v16u8(b))
 	};
-	v.m128i = _mm_hsub_epi32(v.m128i, v.m128i);
-	return v.m64[0];
+	return (v.i64[0] | v.i64[1]) ? 0 : 1;
 }
 
-FORCE_INLINE __m128i _mm_hsubs_epi16(__m128i a, __m128i b)
+FORCE_INLINE int _mm_testz_si128(__m128i a, __m128i b)
 {
-	return vreinterpret_m128i(
-		__builtin_msa_subs_s_h(__builtin_msa_vshf_h(
-		({v8i16 m = {0, 2, 4, 6, 8, 10, 12, 14}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
-		__builtin_msa_vshf_h(
-		({v8i16 m = {1, 3, 5, 7, 9, 11, 13, 15}; m;}),
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+	VREG128 v = {
+		.msa_v16u8 = __builtin_msa_and_v(
+			vreinterpret_v16u8(a), vreinterpret_v16u8(b))
+	};
+	return (v.i64[0] | v.i64[1]) ? 0 : 1;
 }
 
-FORCE_INLINE __m64 _mm_hsubs_pi16(__m64 a, __m64 b)
+FORCE_INLINE int _mm_testnzc_si128(__m128i a, __m128i b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
+	VREG128 vz = {
+		.msa_v16u8 = __builtin_msa_and_v(
+			vreinterpret_v16u8(a), vreinterpret_v16u8(b))
+	};
+	VREG128 vc = {
+		.msa_v16u8 = __builtin_msa_and_v(
+			~vreinterpret_v16u8(a), vreinterpret_v16u8(b))
 	};
-	v.m128i = _mm_hsubs_epi16(v.m128i, v.m128i);
-	return v.m64[0];
+	return (vz.i64[0] | vz.i64[1]) && (vc.i64[0] | vc.i64[1]) ? 1 : 0;
 }
 
-FORCE_INLINE __m128 _mm_mul_ps(__m128 a, __m128 b)
+FORCE_INLINE int _mm_test_mix_ones_zeros(__m128i a, __m128i mask)
 {
-	return vreinterpret_m128(__builtin_msa_fmul_w(
+	VREG128 vz = {
+		.msa_v16u8 = __builtin_msa_and_v(
+			vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
+	};
+	VREG128 vc = {
+		.msa_v16u8 = __builtin_msa_and_v(
+			~vreinterpret_v16u8(a), vreinterpret_v16u8(mask))
+	};
+	return (vz.i64[0] | vz.i64[1]) && (vc.i64[0] | vc.i64[1]) ? 1 : 0;
+}
+
+FORCE_INLINE __m128 _mm_sub_ps(__m128 a, __m128 b)
+{
+	return vreinterpret_m128(__builtin_msa_fsub_w(
 		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m128 _mm_mul_ss(__m128 a, __m128 b)
+FORCE_INLINE __m128 _mm_sub_ss(__m128 a, __m128 b)
 {
-	return _mm_move_ss(a, _mm_mul_ps(a, b));
+	return _mm_move_ss(a, _mm_sub_ps(a, b));
 }
 
-FORCE_INLINE __m128d _mm_mul_pd(__m128d a, __m128d b)
+FORCE_INLINE __m128d _mm_sub_pd(__m128d a, __m128d b)
 {
-	return vreinterpret_m128d(__builtin_msa_fmul_d(
+	return vreinterpret_m128d(__builtin_msa_fsub_d(
 		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-FORCE_INLINE __m128d _mm_mul_sd(__m128d a, __m128d b)
+FORCE_INLINE __m128d _mm_sub_sd(__m128d a, __m128d b)
 {
-	return _mm_move_sd(a, _mm_mul_pd(a, b));
+	return _mm_move_sd(a, _mm_sub_pd(a, b));
 }
 
-FORCE_INLINE __m128i _mm_mul_epu32(__m128i a, __m128i b)
+FORCE_INLINE __m128i _mm_sub_epi64(__m128i a, __m128i b)
 {
-	VREG128 v = {
-		.u64 = {
-			(uint64_t)vreinterpret_nth_u32_m128i(a, 0) *
-			(uint64_t)vreinterpret_nth_u32_m128i(b, 0),
-			(uint64_t)vreinterpret_nth_u32_m128i(a, 2) *
-			(uint64_t)vreinterpret_nth_u32_m128i(b, 2)
-		}
-	};
-	return v.m128i;
+	return vreinterpret_m128i(__builtin_msa_subv_d(
+		vreinterpret_v2i64(a), vreinterpret_v2i64(b)));
 }
 
-FORCE_INLINE __m64 _mm_mul_su32(__m64 a, __m64 b)
+FORCE_INLINE __m128i _mm_sub_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subv_w(
+		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+}
+
+FORCE_INLINE __m128i _mm_sub_epi16(__m128i a, __m128i b)
 {
-	uint32_t *pa = (uint32_t*)&(a);
-	uint32_t *pb = (uint32_t*)&(b);
-	uint64_t r = (uint64_t)pa[0] * (uint64_t)pb[0];
-	return vreinterpret_m64(r);
+	return vreinterpret_m128i(__builtin_msa_subv_h(
+		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
 }
 
-FORCE_INLINE __m128i _mm_mul_epi32(__m128i a, __m128i b)
+FORCE_INLINE __m128i _mm_sub_epi8(__m128i a, __m128i b)
 {
-	VREG128 v = {
-		.i64 = {
-			(int64_t)vreinterpret_nth_i32_m128i(a, 0) *
-			(int64_t)vreinterpret_nth_i32_m128i(b, 0),
-			(int64_t)vreinterpret_nth_i32_m128i(a, 2) *
-			(int64_t)vreinterpret_nth_i32_m128i(b, 2)
-		}
-	};
-	return v.m128i;
+	return vreinterpret_m128i(__builtin_msa_subv_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
 }
 
-FORCE_INLINE __m128i _mm_mullo_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m64 _mm_sub_si64(__m64 a, __m64 b)
 {
-	v8i16 z = v_msa_setzero(v8i16);
-	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
-	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
-	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
-	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
-	v4i32 vo = __builtin_msa_mulv_w(eao, ebo);
-	v4i32 ve = __builtin_msa_mulv_w(eae, ebe);
-	return vreinterpret_m128i(__builtin_msa_ilvev_h(
-		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+	return vreinterpret_m64_i64(
+		vreinterpret_i64_m64(a) - vreinterpret_i64_m64(b));
+}
+
+FORCE_INLINE __m128i _mm_subs_epu16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subs_u_h(
+		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+}
+
+FORCE_INLINE __m128i _mm_subs_epu8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subs_u_b(
+		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+}
+
+FORCE_INLINE __m128i _mm_subs_epi8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subs_s_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+}
+
+FORCE_INLINE __m128i _mm_subs_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subs_s_h(
+		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+}
+
+FORCE_INLINE __m128i _mm_adds_epu16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_adds_u_h(
+		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+}
+
+FORCE_INLINE __m128i _mm_adds_epu8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_adds_u_b(
+		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+}
+
+FORCE_INLINE __m128i _mm_adds_epi8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_adds_s_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+}
+
+FORCE_INLINE __m128i _mm_adds_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_adds_s_h(
+		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+}
+
+FORCE_INLINE __m64 _mm_avg_pu16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(__builtin_msa_aver_u_h(
+		v_msa_fill_m64(v8u16, a), v_msa_fill_m64(v8u16, b)));
+}
+
+#define _m_pavgw(a, b) _mm_avg_pu16(a, b)
+
+FORCE_INLINE __m64 _mm_avg_pu8(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(__builtin_msa_aver_u_b(
+		v_msa_fill_m64(v16u8, a), v_msa_fill_m64(v16u8, b)));
+}
+
+#define _m_pavgb(a, b) _mm_avg_pu8(a, b)
+
+FORCE_INLINE __m128i _mm_avg_epu16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_aver_u_h(
+		vreinterpret_v8u16(a), vreinterpret_v8u16(b)));
+}
+
+FORCE_INLINE __m128i _mm_avg_epu8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_aver_u_b(
+		vreinterpret_v16u8(a), vreinterpret_v16u8(b)));
+}
+
+FORCE_INLINE __m128 _mm_add_ps(__m128 a, __m128 b)
+{
+	return vreinterpret_m128(__builtin_msa_fadd_w(
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+}
+
+FORCE_INLINE __m128d _mm_add_pd(__m128d a, __m128d b)
+{
+	return vreinterpret_m128d(__builtin_msa_fadd_d(
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+}
+
+FORCE_INLINE __m128d _mm_add_sd(__m128d a, __m128d b)
+{
+	return _mm_move_sd(a, _mm_add_pd(a, b));
+}
+
+FORCE_INLINE __m64 _mm_add_si64(__m64 a, __m64 b)
+{
+	return vreinterpret_m64_i64(
+		vreinterpret_i64_m64(a) + vreinterpret_i64_m64(b));
+}
+
+FORCE_INLINE __m128 _mm_add_ss(__m128 a, __m128 b)
+{
+	return _mm_move_ss(a, _mm_add_ps(a, b));
+}
+
+FORCE_INLINE __m128i _mm_add_epi64(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_d(
+		vreinterpret_v2i64(a), vreinterpret_v2i64(b)));
+}
+
+FORCE_INLINE __m128i _mm_add_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_w(
+		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+}
+
+FORCE_INLINE __m128i _mm_add_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_h(
+		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+}
+
+FORCE_INLINE __m128i _mm_add_epi8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+}
+
+/*
+ * `pckev`/`pckod` gather the even/odd lanes of `a` (low half) and `b`
+ * (high half) in one instruction, the horizontal ops are then a single
+ * vertical op between the two.
+ */
+FORCE_INLINE __m128 _mm_hadd_ps(__m128 a, __m128 b)
+{
+	v4i32 ev = __builtin_msa_pckev_w(
+		vreinterpret_v4i32(b), vreinterpret_v4i32(a));
+	v4i32 od = __builtin_msa_pckod_w(
+		vreinterpret_v4i32(b), vreinterpret_v4i32(a));
+	return vreinterpret_m128(__builtin_msa_fadd_w(
+		vreinterpret_v4f32(ev), vreinterpret_v4f32(od)));
+}
+
+FORCE_INLINE __m128d _mm_hadd_pd(__m128d a, __m128d b)
+{
+	v2i64 ev = __builtin_msa_pckev_d(
+		vreinterpret_v2i64(b), vreinterpret_v2i64(a));
+	v2i64 od = __builtin_msa_pckod_d(
+		vreinterpret_v2i64(b), vreinterpret_v2i64(a));
+	return vreinterpret_m128d(__builtin_msa_fadd_d(
+		vreinterpret_v2f64(ev), vreinterpret_v2f64(od)));
+}
+
+FORCE_INLINE __m128i _mm_hadd_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_h(
+		__builtin_msa_pckev_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
+		__builtin_msa_pckod_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+}
+
+FORCE_INLINE __m128i _mm_hadd_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_addv_w(
+		__builtin_msa_pckev_w(vreinterpret_v4i32(b), vreinterpret_v4i32(a)),
+		__builtin_msa_pckod_w(vreinterpret_v4i32(b), vreinterpret_v4i32(a))));
+}
+
+FORCE_INLINE __m64 _mm_hadd_pi16(__m64 a, __m64 b)
+{
+	v8i16 v = v_msa_pack_m64(v8i16, a, b);
+	return v_msa_copy_m64(__builtin_msa_addv_h(
+		__builtin_msa_pckev_h(v, v), __builtin_msa_pckod_h(v, v)));
+}
+
+FORCE_INLINE __m64 _mm_hadd_pi32(__m64 a, __m64 b)
+{
+	v4i32 v = v_msa_pack_m64(v4i32, a, b);
+	return v_msa_copy_m64(__builtin_msa_addv_w(
+		__builtin_msa_pckev_w(v, v), __builtin_msa_pckod_w(v, v)));
+}
+
+FORCE_INLINE __m128i _mm_hadds_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_adds_s_h(
+		__builtin_msa_pckev_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
+		__builtin_msa_pckod_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+}
+
+FORCE_INLINE __m64 _mm_hadds_pi16(__m64 a, __m64 b)
+{
+	v8i16 v = v_msa_pack_m64(v8i16, a, b);
+	return v_msa_copy_m64(__builtin_msa_adds_s_h(
+		__builtin_msa_pckev_h(v, v), __builtin_msa_pckod_h(v, v)));
+}
+
+FORCE_INLINE __m128 _mm_hsub_ps(__m128 a, __m128 b)
+{
+	v4i32 ev = __builtin_msa_pckev_w(
+		vreinterpret_v4i32(b), vreinterpret_v4i32(a));
+	v4i32 od = __builtin_msa_pckod_w(
+		vreinterpret_v4i32(b), vreinterpret_v4i32(a));
+	return vreinterpret_m128(__builtin_msa_fsub_w(
+		vreinterpret_v4f32(ev), vreinterpret_v4f32(od)));
+}
+
+FORCE_INLINE __m128d _mm_hsub_pd(__m128d a, __m128d b)
+{
+	v2i64 ev = __builtin_msa_pckev_d(
+		vreinterpret_v2i64(b), vreinterpret_v2i64(a));
+	v2i64 od = __builtin_msa_pckod_d(
+		vreinterpret_v2i64(b), vreinterpret_v2i64(a));
+	return vreinterpret_m128d(__builtin_msa_fsub_d(
+		vreinterpret_v2f64(ev), vreinterpret_v2f64(od)));
+}
+
+FORCE_INLINE __m128i _mm_hsub_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subv_h(
+		__builtin_msa_pckev_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
+		__builtin_msa_pckod_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+}
+
+FORCE_INLINE __m128i _mm_hsub_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subv_w(
+		__builtin_msa_pckev_w(vreinterpret_v4i32(b), vreinterpret_v4i32(a)),
+		__builtin_msa_pckod_w(vreinterpret_v4i32(b), vreinterpret_v4i32(a))));
+}
+
+FORCE_INLINE __m64 _mm_hsub_pi16(__m64 a, __m64 b)
+{
+	v8i16 v = v_msa_pack_m64(v8i16, a, b);
+	return v_msa_copy_m64(__builtin_msa_subv_h(
+		__builtin_msa_pckev_h(v, v), __builtin_msa_pckod_h(v, v)));
+}
+
+FORCE_INLINE __m64 _mm_hsub_pi32(__m64 a, __m64 b)
+{
+	v4i32 v = v_msa_pack_m64(v4i32, a, b);
+	return v_msa_copy_m64(__builtin_msa_subv_w(
+		__builtin_msa_pckev_w(v, v), __builtin_msa_pckod_w(v, v)));
+}
+
+FORCE_INLINE __m128i _mm_hsubs_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_subs_s_h(
+		__builtin_msa_pckev_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a)),
+		__builtin_msa_pckod_h(vreinterpret_v8i16(b), vreinterpret_v8i16(a))));
+}
+
+FORCE_INLINE __m64 _mm_hsubs_pi16(__m64 a, __m64 b)
+{
+	v8i16 v = v_msa_pack_m64(v8i16, a, b);
+	return v_msa_copy_m64(__builtin_msa_subs_s_h(
+		__builtin_msa_pckev_h(v, v), __builtin_msa_pckod_h(v, v)));
+}
+
+/*
+ * Sum of all lanes of `a`, broadcast to every lane. Same result and
+ * rounding as `_mm_hadd_*(_mm_hadd_*(a, a), _mm_hadd_*(a, a))`, using two
+ * `shf` instead of four `pckev`/`pckod`.
+ */
+FORCE_INLINE __m128 sse2msa_hsum_ps(__m128 a)
+{
+	v4f32 t = __builtin_msa_fadd_w(vreinterpret_v4f32(a), vreinterpret_v4f32(
+		__builtin_msa_shf_w(vreinterpret_v4i32(a), 0xb1)));
+	return vreinterpret_m128(__builtin_msa_fadd_w(t, vreinterpret_v4f32(
+		__builtin_msa_shf_w(vreinterpret_v4i32(t), 0x4e))));
+}
+
+FORCE_INLINE __m128d sse2msa_hsum_pd(__m128d a)
+{
+	return vreinterpret_m128d(__builtin_msa_fadd_d(vreinterpret_v2f64(a),
+		vreinterpret_v2f64(__builtin_msa_shf_w(vreinterpret_v4i32(a), 0x4e))));
+}
+
+FORCE_INLINE __m128i sse2msa_hsum_epi32(__m128i a)
+{
+	v4i32 t = __builtin_msa_addv_w(vreinterpret_v4i32(a),
+		__builtin_msa_shf_w(vreinterpret_v4i32(a), 0xb1));
+	return vreinterpret_m128i(__builtin_msa_addv_w(t,
+		__builtin_msa_shf_w(t, 0x4e)));
+}
+
+FORCE_INLINE __m128 _mm_mul_ps(__m128 a, __m128 b)
+{
+	return vreinterpret_m128(__builtin_msa_fmul_w(
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+}
+
+FORCE_INLINE __m128 _mm_mul_ss(__m128 a, __m128 b)
+{
+	return _mm_move_ss(a, _mm_mul_ps(a, b));
+}
+
+FORCE_INLINE __m128d _mm_mul_pd(__m128d a, __m128d b)
+{
+	return vreinterpret_m128d(__builtin_msa_fmul_d(
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+}
+
+FORCE_INLINE __m128d _mm_mul_sd(__m128d a, __m128d b)
+{
+	return _mm_move_sd(a, _mm_mul_pd(a, b));
+}
+
+FORCE_INLINE __m128i _mm_mul_epu32(__m128i a, __m128i b)
+{
+	VREG128 v = {
+		.u64 = {
+			(uint64_t)vreinterpret_nth_u32_m128i(a, 0) *
+			(uint64_t)vreinterpret_nth_u32_m128i(b, 0),
+			(uint64_t)vreinterpret_nth_u32_m128i(a, 2) *
+			(uint64_t)vreinterpret_nth_u32_m128i(b, 2)
+		}
+	};
+	return v.m128i;
+}
+
+FORCE_INLINE __m64 _mm_mul_su32(__m64 a, __m64 b)
+{
+	uint64_t r = (uint64_t)(uint32_t)vreinterpret_i64_m64(a) *
+		(uint64_t)(uint32_t)vreinterpret_i64_m64(b);
+	return vreinterpret_m64_i64(r);
+}
+
+FORCE_INLINE __m128i _mm_mul_epi32(__m128i a, __m128i b)
+{
+	VREG128 v = {
+		.i64 = {
+			(int64_t)vreinterpret_nth_i32_m128i(a, 0) *
+			(int64_t)vreinterpret_nth_i32_m128i(b, 0),
+			(int64_t)vreinterpret_nth_i32_m128i(a, 2) *
+			(int64_t)vreinterpret_nth_i32_m128i(b, 2)
+		}
+	};
+	return v.m128i;
+}
+
+FORCE_INLINE __m128i _mm_mullo_epi16(__m128i a, __m128i b)
+{
+	v8i16 z = v_msa_setzero(v8i16);
+	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
+	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
+	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
+	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
+	v4i32 vo = __builtin_msa_mulv_w(eao, ebo);
+	v4i32 ve = __builtin_msa_mulv_w(eae, ebe);
+	return vreinterpret_m128i(__builtin_msa_ilvev_h(
+		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+}
+
+FORCE_INLINE __m128i _mm_mullo_epi32(__m128i a, __m128i b)
+{
+	v4i32 z = v_msa_setzero(v4i32);
+	v2i64 eao = __builtin_msa_hadd_s_d(vreinterpret_v4i32(a), z);
+	v2i64 eae = __builtin_msa_hadd_s_d(z, vreinterpret_v4i32(a));
+	v2i64 ebo = __builtin_msa_hadd_s_d(vreinterpret_v4i32(b), z);
+	v2i64 ebe = __builtin_msa_hadd_s_d(z, vreinterpret_v4i32(b));
+	v2i64 vo = __builtin_msa_mulv_d(eao, ebo);
+	v2i64 ve = __builtin_msa_mulv_d(eae, ebe);
+	return vreinterpret_m128i(__builtin_msa_ilvev_w(
+		vreinterpret_v4i32(vo), vreinterpret_v4i32(ve)));
+}
+
+FORCE_INLINE __m128i _mm_mulhi_epi16(__m128i a, __m128i b)
+{
+	v8i16 z = v_msa_setzero(v8i16);
+	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
+	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
+	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
+	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
+	v4i32 vo = __builtin_msa_mulv_w(eao, ebo);
+	v4i32 ve = __builtin_msa_mulv_w(eae, ebe);
+	return vreinterpret_m128i(__builtin_msa_ilvod_h(
+		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+}
+
+FORCE_INLINE __m128i _mm_mulhi_epu16(__m128i a, __m128i b)
+{
+	v8u16 z = v_msa_setzero(v8u16);
+	v4u32 eao = __builtin_msa_hadd_u_w(vreinterpret_v8u16(a), z);
+	v4u32 eae = __builtin_msa_hadd_u_w(z, vreinterpret_v8u16(a));
+	v4u32 ebo = __builtin_msa_hadd_u_w(vreinterpret_v8u16(b), z);
+	v4u32 ebe = __builtin_msa_hadd_u_w(z, vreinterpret_v8u16(b));
+	v4i32 vo = __builtin_msa_mulv_w((v4i32)eao, (v4i32)ebo);
+	v4i32 ve = __builtin_msa_mulv_w((v4i32)eae, (v4i32)ebe);
+	return vreinterpret_m128i(__builtin_msa_ilvod_h(
+		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+}
+
+FORCE_INLINE __m64 _mm_mullo_pi16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(_mm_mullo_epi16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
+}
+
+FORCE_INLINE __m64 _mm_mulhi_pi16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(_mm_mulhi_epi16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
+}
+
+FORCE_INLINE __m64 _mm_mulhi_pu16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(_mm_mulhi_epu16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
+}
+
+#define _m_pmulhuw(a, b) _mm_mulhi_pu16(a, b)
+
+FORCE_INLINE __m128i _mm_mulhrs_epi16(__m128i a, __m128i b)
+{
+	v8i16 z = v_msa_setzero(v8i16);
+	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
+	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
+	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
+	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
+	v4i32 vo = __builtin_msa_srai_w(__builtin_msa_mulv_w(eao, ebo), 14) + 1;
+	v4i32 ve = __builtin_msa_srai_w(__builtin_msa_mulv_w(eae, ebe), 14) + 1;
+	vo = __builtin_msa_srli_w(vo, 1);
+	ve = __builtin_msa_srli_w(ve, 1);
+	return vreinterpret_m128i(__builtin_msa_ilvev_h(
+		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+}
+
+FORCE_INLINE __m64 _mm_mulhrs_pi16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(_mm_mulhrs_epi16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
+}
+
+FORCE_INLINE __m128i _mm_maddubs_epi16(__m128i a, __m128i b)
+{
+	v16u8 z = v_msa_setzero(v16u8);
+	v16i8 i = v_msa_setzero(v16i8);
+	v8u16 eao = __builtin_msa_hadd_u_h(vreinterpret_v16u8(a), z);
+	v8u16 eae = __builtin_msa_hadd_u_h(z, vreinterpret_v16u8(a));
+	v8i16 ebo = __builtin_msa_hadd_s_h(vreinterpret_v16i8(b), i);
+	v8i16 ebe = __builtin_msa_hadd_s_h(i, vreinterpret_v16i8(b));
+	v8i16 vo = __builtin_msa_mulv_h((v8i16)eao, ebo);
+	v8i16 ve = __builtin_msa_mulv_h((v8i16)eae, ebe);
+	return vreinterpret_m128i(__builtin_msa_adds_s_h(vo, ve));
+}
+
+FORCE_INLINE __m64 _mm_maddubs_pi16(__m64 a, __m64 b)
+{
+	return v_msa_copy_m64(_mm_maddubs_epi16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
+}
+
+FORCE_INLINE __m128i _mm_madd_epi16(__m128i a, __m128i b)
+{
+	VREG128 v = {
+		.i32 = {
+			(int32_t)vreinterpret_nth_i16_m128i(a, 0) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 0) +
+			(int32_t)vreinterpret_nth_i16_m128i(a, 1) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 1),
+			(int32_t)vreinterpret_nth_i16_m128i(a, 2) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 2) +
+			(int32_t)vreinterpret_nth_i16_m128i(a, 3) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 3),
+			(int32_t)vreinterpret_nth_i16_m128i(a, 4) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 4) +
+			(int32_t)vreinterpret_nth_i16_m128i(a, 5) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 5),
+			(int32_t)vreinterpret_nth_i16_m128i(a, 6) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 6) +
+			(int32_t)vreinterpret_nth_i16_m128i(a, 7) *
+			(int32_t)vreinterpret_nth_i16_m128i(b, 7),
+		}
+	};
+	return v.m128i;
+}
+
+FORCE_INLINE __m128 _mm_addsub_ps(__m128 a, __m128 b)
+{
+	v4f32 mask = {-1.0f, 1.0f, -1.0f, 1.0f};
+	return vreinterpret_m128(__builtin_msa_fmadd_w(
+		vreinterpret_v4f32(b), mask, vreinterpret_v4f32(a)));
+}
+
+FORCE_INLINE __m128d _mm_addsub_pd(__m128d a, __m128d b)
+{
+	v2f64 mask = {-1.0f, 1.0f};
+	return vreinterpret_m128d(__builtin_msa_fmadd_d(
+		vreinterpret_v2f64(b), mask, vreinterpret_v2f64(a)));
+}
+
+FORCE_INLINE __m128 _mm_div_ps(__m128 a, __m128 b)
+{
+	return vreinterpret_m128(__builtin_msa_fdiv_w(
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+}
+
+FORCE_INLINE __m128 _mm_div_ss(__m128 a, __m128 b)
+{
+	return _mm_move_ss(a, _mm_div_ps(a, b));
+}
+
+FORCE_INLINE __m128d _mm_div_pd(__m128d a, __m128d b)
+{
+	return vreinterpret_m128d(__builtin_msa_fdiv_d(
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+}
+
+FORCE_INLINE __m128d _mm_div_sd(__m128d a, __m128d b)
+{
+	return _mm_move_sd(a, _mm_div_pd(a, b));
+}
+
+FORCE_INLINE __m128 _mm_rcp_ps(__m128 a)
+{
+	return vreinterpret_m128(
+		__builtin_msa_frcp_w(vreinterpret_v4f32(a)));
+}
+
+FORCE_INLINE __m128 _mm_rcp_ss(__m128 a)
+{
+	return _mm_move_ss(a, _mm_rcp_ps(a));
+}
+
+FORCE_INLINE __m128 _mm_sqrt_ps(__m128 a)
+{
+	return vreinterpret_m128(
+		__builtin_msa_fsqrt_w(vreinterpret_v4f32(a)));
+}
+
+FORCE_INLINE __m128d _mm_sqrt_pd(__m128d a)
+{
+	return vreinterpret_m128d(
+		__builtin_msa_fsqrt_d(vreinterpret_v2f64(a)));
+}
+
+FORCE_INLINE __m128d _mm_sqrt_sd(__m128d a, __m128d b)
+{
+    return _mm_move_sd(a, _mm_sqrt_pd(b));
+}
+
+FORCE_INLINE __m128 _mm_sqrt_ss(__m128 a)
+{
+	return _mm_move_ss(a, _mm_sqrt_ps(a));
+}
+
+FORCE_INLINE __m128 _mm_rsqrt_ps(__m128 a)
+{
+	return vreinterpret_m128(
+		__builtin_msa_frsqrt_w(vreinterpret_v4f32(a)));
+}
+
+FORCE_INLINE __m128 _mm_rsqrt_ss(__m128 a)
+{
+	return _mm_move_ss(a, _mm_rsqrt_ps(a));
+}
+
+int _mm_popcnt_u32(unsigned int a)
+{
+	VREG128 v = {.u32 = {a, 0, 0, 0}};
+	v.msa_v4i32 = __builtin_msa_pcnt_w(v.msa_v4i32);
+	return v.i32[0];
+}
+
+FORCE_INLINE int64_t _mm_popcnt_u64(uint64_t a)
+{
+	VREG128 v = {.u64 = {a, 0}};
+	v.msa_v2i64 = __builtin_msa_pcnt_d(v.msa_v2i64);
+	return v.i64[0];
+}
+
+/* Ref: nmmintrin.h
+ * CRC32-C (Castagnoli, reflected polynomial 0x82f63b78). As on x86 there
+ * is no pre- or post-inversion; the value operand is consumed least
+ * significant byte first regardless of memory endianness. R6 cores with
+ * the CRC ASE (-mcrc) use crc32c{b,h,w,d}, everything else slicing-by-8.
+ */
+#define SSE2MSA_CRC32C_POLY 0x82f63b78u
+
+#if defined(__mips_crc)
+#define v_msa_crc32c_insn(insn, crc, v)                                 \
+	({                                                              \
+		uint32_t _c = (crc);                                    \
+		__asm__("crc32c" insn " %0, %1, %0" : "+r"(_c) : "r"(v)); \
+		_c;                                                     \
+	})
+
+FORCE_INLINE unsigned int _mm_crc32_u8(unsigned int crc, unsigned char v)
+{
+	return v_msa_crc32c_insn("b", crc, (uint32_t)v);
+}
+
+FORCE_INLINE unsigned int _mm_crc32_u16(unsigned int crc, unsigned short v)
+{
+	return v_msa_crc32c_insn("h", crc, (uint32_t)v);
+}
+
+FORCE_INLINE unsigned int _mm_crc32_u32(unsigned int crc, unsigned int v)
+{
+	return v_msa_crc32c_insn("w", crc, v);
+}
+
+FORCE_INLINE unsigned long long _mm_crc32_u64(unsigned long long crc,
+					      unsigned long long v)
+{
+#if defined(__mips64)
+	return v_msa_crc32c_insn("d", crc, v);
+#else
+	return _mm_crc32_u32(_mm_crc32_u32(crc, v), v >> 32);
+#endif
+}
+#else
+static const uint32_t sse2msa_crc32c_table[8][256] = {
+	{
+		0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f,
+		0x35f1141c, 0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc,
+		0x6be22838, 0x9989ab3b, 0x4d43cfd0, 0xbf284cd3, 0xac78bf27,
+		0x5e133c24, 0x105ec76f, 0xe235446c, 0xf165b798, 0x030e349b,
+		0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384, 0x9a879fa0,
+		0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+		0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29,
+		0x33ed7d2a, 0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35,
+		0xaa64d611, 0x580f5512, 0x4b5fa6e6, 0xb93425e5, 0x6dfe410e,
+		0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa, 0x30e349b1, 0xc288cab2,
+		0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad, 0x1642ae59,
+		0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+		0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc,
+		0xb3109ebf, 0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0,
+		0x67dafa54, 0x95b17957, 0xcba24573, 0x39c9c670, 0x2a993584,
+		0xd8f2b687, 0x0c38d26c, 0xfe53516f, 0xed03a29b, 0x1f682198,
+		0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927, 0x96bf4dcc,
+		0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+		0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4,
+		0x0f36e6f7, 0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096,
+		0xa65c047d, 0x5437877e, 0x4767748a, 0xb50cf789, 0xeb1fcbad,
+		0x197448ae, 0x0a24bb5a, 0xf84f3859, 0x2c855cb2, 0xdeeedfb1,
+		0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e, 0x90a324fa,
+		0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+		0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd,
+		0xceb018de, 0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b,
+		0x63cd4b8f, 0x91a6c88c, 0x456cac67, 0xb7072f64, 0xa457dc90,
+		0x563c5f93, 0x082f63b7, 0xfa44e0b4, 0xe9141340, 0x1b7f9043,
+		0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c, 0x92a8fc17,
+		0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+		0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f,
+		0x0b21572c, 0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033,
+		0xa24bb5a6, 0x502036a5, 0x4370c551, 0xb11b4652, 0x65d122b9,
+		0x97baa1ba, 0x84ea524e, 0x7681d14d, 0x2892ed69, 0xdaf96e6a,
+		0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975, 0x0e330a81,
+		0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+		0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06,
+		0xcaa7a905, 0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a,
+		0x1e6dcdee, 0xec064eed, 0xc38d26c4, 0x31e6a5c7, 0x22b65633,
+		0xd0ddd530, 0x0417b1db, 0xf67c32d8, 0xe52cc12c, 0x1747422f,
+		0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff, 0x8ecee914,
+		0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+		0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643,
+		0x07198540, 0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90,
+		0x9e902e7b, 0x6cfbad78, 0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a,
+		0x115b2b19, 0x020bd8ed, 0xf0605bee, 0x24aa3f05, 0xd6c1bc06,
+		0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6, 0x88d28022,
+		0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+		0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a,
+		0xc69f7b69, 0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9,
+		0x988c474d, 0x6ae7c44e, 0xbe2da0a5, 0x4c4623a6, 0x5f16d052,
+		0xad7d5351
+	},
+	{
+		0x00000000, 0x13a29877, 0x274530ee, 0x34e7a899, 0x4e8a61dc,
+		0x5d28f9ab, 0x69cf5132, 0x7a6dc945, 0x9d14c3b8, 0x8eb65bcf,
+		0xba51f356, 0xa9f36b21, 0xd39ea264, 0xc03c3a13, 0xf4db928a,
+		0xe7790afd, 0x3fc5f181, 0x2c6769f6, 0x1880c16f, 0x0b225918,
+		0x714f905d, 0x62ed082a, 0x560aa0b3, 0x45a838c4, 0xa2d13239,
+		0xb173aa4e, 0x859402d7, 0x96369aa0, 0xec5b53e5, 0xfff9cb92,
+		0xcb1e630b, 0xd8bcfb7c, 0x7f8be302, 0x6c297b75, 0x58ced3ec,
+		0x4b6c4b9b, 0x310182de, 0x22a31aa9, 0x1644b230, 0x05e62a47,
+		0xe29f20ba, 0xf13db8cd, 0xc5da1054, 0xd6788823, 0xac154166,
+		0xbfb7d911, 0x8b507188, 0x98f2e9ff, 0x404e1283, 0x53ec8af4,
+		0x670b226d, 0x74a9ba1a, 0x0ec4735f, 0x1d66eb28, 0x298143b1,
+		0x3a23dbc6, 0xdd5ad13b, 0xcef8494c, 0xfa1fe1d5, 0xe9bd79a2,
+		0x93d0b0e7, 0x80722890, 0xb4958009, 0xa737187e, 0xff17c604,
+		0xecb55e73, 0xd852f6ea, 0xcbf06e9d, 0xb19da7d8, 0xa23f3faf,
+		0x96d89736, 0x857a0f41, 0x620305bc, 0x71a19dcb, 0x45463552,
+		0x56e4ad25, 0x2c896460, 0x3f2bfc17, 0x0bcc548e, 0x186eccf9,
+		0xc0d23785, 0xd370aff2, 0xe797076b, 0xf4359f1c, 0x8e585659,
+		0x9dface2e, 0xa91d66b7, 0xbabffec0, 0x5dc6f43d, 0x4e646c4a,
+		0x7a83c4d3, 0x69215ca4, 0x134c95e1, 0x00ee0d96, 0x3409a50f,
+		0x27ab3d78, 0x809c2506, 0x933ebd71, 0xa7d915e8, 0xb47b8d9f,
+		0xce1644da, 0xddb4dcad, 0xe9537434, 0xfaf1ec43, 0x1d88e6be,
+		0x0e2a7ec9, 0x3acdd650, 0x296f4e27, 0x53028762, 0x40a01f15,
+		0x7447b78c, 0x67e52ffb, 0xbf59d487, 0xacfb4cf0, 0x981ce469,
+		0x8bbe7c1e, 0xf1d3b55b, 0xe2712d2c, 0xd69685b5, 0xc5341dc2,
+		0x224d173f, 0x31ef8f48, 0x050827d1, 0x16aabfa6, 0x6cc776e3,
+		0x7f65ee94, 0x4b82460d, 0x5820de7a, 0xfbc3faf9, 0xe861628e,
+		0xdc86ca17, 0xcf245260, 0xb5499b25, 0xa6eb0352, 0x920cabcb,
+		0x81ae33bc, 0x66d73941, 0x7575a136, 0x419209af, 0x523091d8,
+		0x285d589d, 0x3bffc0ea, 0x0f186873, 0x1cbaf004, 0xc4060b78,
+		0xd7a4930f, 0xe3433b96, 0xf0e1a3e1, 0x8a8c6aa4, 0x992ef2d3,
+		0xadc95a4a, 0xbe6bc23d, 0x5912c8c0, 0x4ab050b7, 0x7e57f82e,
+		0x6df56059, 0x1798a91c, 0x043a316b, 0x30dd99f2, 0x237f0185,
+		0x844819fb, 0x97ea818c, 0xa30d2915, 0xb0afb162, 0xcac27827,
+		0xd960e050, 0xed8748c9, 0xfe25d0be, 0x195cda43, 0x0afe4234,
+		0x3e19eaad, 0x2dbb72da, 0x57d6bb9f, 0x447423e8, 0x70938b71,
+		0x63311306, 0xbb8de87a, 0xa82f700d, 0x9cc8d894, 0x8f6a40e3,
+		0xf50789a6, 0xe6a511d1, 0xd242b948, 0xc1e0213f, 0x26992bc2,
+		0x353bb3b5, 0x01dc1b2c, 0x127e835b, 0x68134a1e, 0x7bb1d269,
+		0x4f567af0, 0x5cf4e287, 0x04d43cfd, 0x1776a48a, 0x23910c13,
+		0x30339464, 0x4a5e5d21, 0x59fcc556, 0x6d1b6dcf, 0x7eb9f5b8,
+		0x99c0ff45, 0x8a626732, 0xbe85cfab, 0xad2757dc, 0xd74a9e99,
+		0xc4e806ee, 0xf00fae77, 0xe3ad3600, 0x3b11cd7c, 0x28b3550b,
+		0x1c54fd92, 0x0ff665e5, 0x759baca0, 0x663934d7, 0x52de9c4e,
+		0x417c0439, 0xa6050ec4, 0xb5a796b3, 0x81403e2a, 0x92e2a65d,
+		0xe88f6f18, 0xfb2df76f, 0xcfca5ff6, 0xdc68c781, 0x7b5fdfff,
+		0x68fd4788, 0x5c1aef11, 0x4fb87766, 0x35d5be23, 0x26772654,
+		0x12908ecd, 0x013216ba, 0xe64b1c47, 0xf5e98430, 0xc10e2ca9,
+		0xd2acb4de, 0xa8c17d9b, 0xbb63e5ec, 0x8f844d75, 0x9c26d502,
+		0x449a2e7e, 0x5738b609, 0x63df1e90, 0x707d86e7, 0x0a104fa2,
+		0x19b2d7d5, 0x2d557f4c, 0x3ef7e73b, 0xd98eedc6, 0xca2c75b1,
+		0xfecbdd28, 0xed69455f, 0x97048c1a, 0x84a6146d, 0xb041bcf4,
+		0xa3e32483
+	},
+	{
+		0x00000000, 0xa541927e, 0x4f6f520d, 0xea2ec073, 0x9edea41a,
+		0x3b9f3664, 0xd1b1f617, 0x74f06469, 0x38513ec5, 0x9d10acbb,
+		0x773e6cc8, 0xd27ffeb6, 0xa68f9adf, 0x03ce08a1, 0xe9e0c8d2,
+		0x4ca15aac, 0x70a27d8a, 0xd5e3eff4, 0x3fcd2f87, 0x9a8cbdf9,
+		0xee7cd990, 0x4b3d4bee, 0xa1138b9d, 0x045219e3, 0x48f3434f,
+		0xedb2d131, 0x079c1142, 0xa2dd833c, 0xd62de755, 0x736c752b,
+		0x9942b558, 0x3c032726, 0xe144fb14, 0x4405696a, 0xae2ba919,
+		0x0b6a3b67, 0x7f9a5f0e, 0xdadbcd70, 0x30f50d03, 0x95b49f7d,
+		0xd915c5d1, 0x7c5457af, 0x967a97dc, 0x333b05a2, 0x47cb61cb,
+		0xe28af3b5, 0x08a433c6, 0xade5a1b8, 0x91e6869e, 0x34a714e0,
+		0xde89d493, 0x7bc846ed, 0x0f382284, 0xaa79b0fa, 0x40577089,
+		0xe516e2f7, 0xa9b7b85b, 0x0cf62a25, 0xe6d8ea56, 0x43997828,
+		0x37691c41, 0x92288e3f, 0x78064e4c, 0xdd47dc32, 0xc76580d9,
+		0x622412a7, 0x880ad2d4, 0x2d4b40aa, 0x59bb24c3, 0xfcfab6bd,
+		0x16d476ce, 0xb395e4b0, 0xff34be1c, 0x5a752c62, 0xb05bec11,
+		0x151a7e6f, 0x61ea1a06, 0xc4ab8878, 0x2e85480b, 0x8bc4da75,
+		0xb7c7fd53, 0x12866f2d, 0xf8a8af5e, 0x5de93d20, 0x29195949,
+		0x8c58cb37, 0x66760b44, 0xc337993a, 0x8f96c396, 0x2ad751e8,
+		0xc0f9919b, 0x65b803e5, 0x1148678c, 0xb409f5f2, 0x5e273581,
+		0xfb66a7ff, 0x26217bcd, 0x8360e9b3, 0x694e29c0, 0xcc0fbbbe,
+		0xb8ffdfd7, 0x1dbe4da9, 0xf7908dda, 0x52d11fa4, 0x1e704508,
+		0xbb31d776, 0x511f1705, 0xf45e857b, 0x80aee112, 0x25ef736c,
+		0xcfc1b31f, 0x6a802161, 0x56830647, 0xf3c29439, 0x19ec544a,
+		0xbcadc634, 0xc85da25d, 0x6d1c3023, 0x8732f050, 0x2273622e,
+		0x6ed23882, 0xcb93aafc, 0x21bd6a8f, 0x84fcf8f1, 0xf00c9c98,
+		0x554d0ee6, 0xbf63ce95, 0x1a225ceb, 0x8b277743, 0x2e66e53d,
+		0xc448254e, 0x6109b730, 0x15f9d359, 0xb0b84127, 0x5a968154,
+		0xffd7132a, 0xb3764986, 0x1637dbf8, 0xfc191b8b, 0x595889f5,
+		0x2da8ed9c, 0x88e97fe2, 0x62c7bf91, 0xc7862def, 0xfb850ac9,
+		0x5ec498b7, 0xb4ea58c4, 0x11abcaba, 0x655baed3, 0xc01a3cad,
+		0x2a34fcde, 0x8f756ea0, 0xc3d4340c, 0x6695a672, 0x8cbb6601,
+		0x29faf47f, 0x5d0a9016, 0xf84b0268, 0x1265c21b, 0xb7245065,
+		0x6a638c57, 0xcf221e29, 0x250cde5a, 0x804d4c24, 0xf4bd284d,
+		0x51fcba33, 0xbbd27a40, 0x1e93e83e, 0x5232b292, 0xf77320ec,
+		0x1d5de09f, 0xb81c72e1, 0xccec1688, 0x69ad84f6, 0x83834485,
+		0x26c2d6fb, 0x1ac1f1dd, 0xbf8063a3, 0x55aea3d0, 0xf0ef31ae,
+		0x841f55c7, 0x215ec7b9, 0xcb7007ca, 0x6e3195b4, 0x2290cf18,
+		0x87d15d66, 0x6dff9d15, 0xc8be0f6b, 0xbc4e6b02, 0x190ff97c,
+		0xf321390f, 0x5660ab71, 0x4c42f79a, 0xe90365e4, 0x032da597,
+		0xa66c37e9, 0xd29c5380, 0x77ddc1fe, 0x9df3018d, 0x38b293f3,
+		0x7413c95f, 0xd1525b21, 0x3b7c9b52, 0x9e3d092c, 0xeacd6d45,
+		0x4f8cff3b, 0xa5a23f48, 0x00e3ad36, 0x3ce08a10, 0x99a1186e,
+		0x738fd81d, 0xd6ce4a63, 0xa23e2e0a, 0x077fbc74, 0xed517c07,
+		0x4810ee79, 0x04b1b4d5, 0xa1f026ab, 0x4bdee6d8, 0xee9f74a6,
+		0x9a6f10cf, 0x3f2e82b1, 0xd50042c2, 0x7041d0bc, 0xad060c8e,
+		0x08479ef0, 0xe2695e83, 0x4728ccfd, 0x33d8a894, 0x96993aea,
+		0x7cb7fa99, 0xd9f668e7, 0x9557324b, 0x3016a035, 0xda386046,
+		0x7f79f238, 0x0b899651, 0xaec8042f, 0x44e6c45c, 0xe1a75622,
+		0xdda47104, 0x78e5e37a, 0x92cb2309, 0x378ab177, 0x437ad51e,
+		0xe63b4760, 0x0c158713, 0xa954156d, 0xe5f54fc1, 0x40b4ddbf,
+		0xaa9a1dcc, 0x0fdb8fb2, 0x7b2bebdb, 0xde6a79a5, 0x3444b9d6,
+		0x91052ba8
+	},
+	{
+		0x00000000, 0xdd45aab8, 0xbf672381, 0x62228939, 0x7b2231f3,
+		0xa6679b4b, 0xc4451272, 0x1900b8ca, 0xf64463e6, 0x2b01c95e,
+		0x49234067, 0x9466eadf, 0x8d665215, 0x5023f8ad, 0x32017194,
+		0xef44db2c, 0xe964b13d, 0x34211b85, 0x560392bc, 0x8b463804,
+		0x924680ce, 0x4f032a76, 0x2d21a34f, 0xf06409f7, 0x1f20d2db,
+		0xc2657863, 0xa047f15a, 0x7d025be2, 0x6402e328, 0xb9474990,
+		0xdb65c0a9, 0x06206a11, 0xd725148b, 0x0a60be33, 0x6842370a,
+		0xb5079db2, 0xac072578, 0x71428fc0, 0x136006f9, 0xce25ac41,
+		0x2161776d, 0xfc24ddd5, 0x9e0654ec, 0x4343fe54, 0x5a43469e,
+		0x8706ec26, 0xe524651f, 0x3861cfa7, 0x3e41a5b6, 0xe3040f0e,
+		0x81268637, 0x5c632c8f, 0x45639445, 0x98263efd, 0xfa04b7c4,
+		0x27411d7c, 0xc805c650, 0x15406ce8, 0x7762e5d1, 0xaa274f69,
+		0xb327f7a3, 0x6e625d1b, 0x0c40d422, 0xd1057e9a, 0xaba65fe7,
+		0x76e3f55f, 0x14c17c66, 0xc984d6de, 0xd0846e14, 0x0dc1c4ac,
+		0x6fe34d95, 0xb2a6e72d, 0x5de23c01, 0x80a796b9, 0xe2851f80,
+		0x3fc0b538, 0x26c00df2, 0xfb85a74a, 0x99a72e73, 0x44e284cb,
+		0x42c2eeda, 0x9f874462, 0xfda5cd5b, 0x20e067e3, 0x39e0df29,
+		0xe4a57591, 0x8687fca8, 0x5bc25610, 0xb4868d3c, 0x69c32784,
+		0x0be1aebd, 0xd6a40405, 0xcfa4bccf, 0x12e11677, 0x70c39f4e,
+		0xad8635f6, 0x7c834b6c, 0xa1c6e1d4, 0xc3e468ed, 0x1ea1c255,
+		0x07a17a9f, 0xdae4d027, 0xb8c6591e, 0x6583f3a6, 0x8ac7288a,
+		0x57828232, 0x35a00b0b, 0xe8e5a1b3, 0xf1e51979, 0x2ca0b3c1,
+		0x4e823af8, 0x93c79040, 0x95e7fa51, 0x48a250e9, 0x2a80d9d0,
+		0xf7c57368, 0xeec5cba2, 0x3380611a, 0x51a2e823, 0x8ce7429b,
+		0x63a399b7, 0xbee6330f, 0xdcc4ba36, 0x0181108e, 0x1881a844,
+		0xc5c402fc, 0xa7e68bc5, 0x7aa3217d, 0x52a0c93f, 0x8fe56387,
+		0xedc7eabe, 0x30824006, 0x2982f8cc, 0xf4c75274, 0x96e5db4d,
+		0x4ba071f5, 0xa4e4aad9, 0x79a10061, 0x1b838958, 0xc6c623e0,
+		0xdfc69b2a, 0x02833192, 0x60a1b8ab, 0xbde41213, 0xbbc47802,
+		0x6681d2ba, 0x04a35b83, 0xd9e6f13b, 0xc0e649f1, 0x1da3e349,
+		0x7f816a70, 0xa2c4c0c8, 0x4d801be4, 0x90c5b15c, 0xf2e73865,
+		0x2fa292dd, 0x36a22a17, 0xebe780af, 0x89c50996, 0x5480a32e,
+		0x8585ddb4, 0x58c0770c, 0x3ae2fe35, 0xe7a7548d, 0xfea7ec47,
+		0x23e246ff, 0x41c0cfc6, 0x9c85657e, 0x73c1be52, 0xae8414ea,
+		0xcca69dd3, 0x11e3376b, 0x08e38fa1, 0xd5a62519, 0xb784ac20,
+		0x6ac10698, 0x6ce16c89, 0xb1a4c631, 0xd3864f08, 0x0ec3e5b0,
+		0x17c35d7a, 0xca86f7c2, 0xa8a47efb, 0x75e1d443, 0x9aa50f6f,
+		0x47e0a5d7, 0x25c22cee, 0xf8878656, 0xe1873e9c, 0x3cc29424,
+		0x5ee01d1d, 0x83a5b7a5, 0xf90696d8, 0x24433c60, 0x4661b559,
+		0x9b241fe1, 0x8224a72b, 0x5f610d93, 0x3d4384aa, 0xe0062e12,
+		0x0f42f53e, 0xd2075f86, 0xb025d6bf, 0x6d607c07, 0x7460c4cd,
+		0xa9256e75, 0xcb07e74c, 0x16424df4, 0x106227e5, 0xcd278d5d,
+		0xaf050464, 0x7240aedc, 0x6b401616, 0xb605bcae, 0xd4273597,
+		0x09629f2f, 0xe6264403, 0x3b63eebb, 0x59416782, 0x8404cd3a,
+		0x9d0475f0, 0x4041df48, 0x22635671, 0xff26fcc9, 0x2e238253,
+		0xf36628eb, 0x9144a1d2, 0x4c010b6a, 0x5501b3a0, 0x88441918,
+		0xea669021, 0x37233a99, 0xd867e1b5, 0x05224b0d, 0x6700c234,
+		0xba45688c, 0xa345d046, 0x7e007afe, 0x1c22f3c7, 0xc167597f,
+		0xc747336e, 0x1a0299d6, 0x782010ef, 0xa565ba57, 0xbc65029d,
+		0x6120a825, 0x0302211c, 0xde478ba4, 0x31035088, 0xec46fa30,
+		0x8e647309, 0x5321d9b1, 0x4a21617b, 0x9764cbc3, 0xf54642fa,
+		0x2803e842
+	},
+	{
+		0x00000000, 0x38116fac, 0x7022df58, 0x4833b0f4, 0xe045beb0,
+		0xd854d11c, 0x906761e8, 0xa8760e44, 0xc5670b91, 0xfd76643d,
+		0xb545d4c9, 0x8d54bb65, 0x2522b521, 0x1d33da8d, 0x55006a79,
+		0x6d1105d5, 0x8f2261d3, 0xb7330e7f, 0xff00be8b, 0xc711d127,
+		0x6f67df63, 0x5776b0cf, 0x1f45003b, 0x27546f97, 0x4a456a42,
+		0x725405ee, 0x3a67b51a, 0x0276dab6, 0xaa00d4f2, 0x9211bb5e,
+		0xda220baa, 0xe2336406, 0x1ba8b557, 0x23b9dafb, 0x6b8a6a0f,
+		0x539b05a3, 0xfbed0be7, 0xc3fc644b, 0x8bcfd4bf, 0xb3debb13,
+		0xdecfbec6, 0xe6ded16a, 0xaeed619e, 0x96fc0e32, 0x3e8a0076,
+		0x069b6fda, 0x4ea8df2e, 0x76b9b082, 0x948ad484, 0xac9bbb28,
+		0xe4a80bdc, 0xdcb96470, 0x74cf6a34, 0x4cde0598, 0x04edb56c,
+		0x3cfcdac0, 0x51eddf15, 0x69fcb0b9, 0x21cf004d, 0x19de6fe1,
+		0xb1a861a5, 0x89b90e09, 0xc18abefd, 0xf99bd151, 0x37516aae,
+		0x0f400502, 0x4773b5f6, 0x7f62da5a, 0xd714d41e, 0xef05bbb2,
+		0xa7360b46, 0x9f2764ea, 0xf236613f, 0xca270e93, 0x8214be67,
+		0xba05d1cb, 0x1273df8f, 0x2a62b023, 0x625100d7, 0x5a406f7b,
+		0xb8730b7d, 0x806264d1, 0xc851d425, 0xf040bb89, 0x5836b5cd,
+		0x6027da61, 0x28146a95, 0x10050539, 0x7d1400ec, 0x45056f40,
+		0x0d36dfb4, 0x3527b018, 0x9d51be5c, 0xa540d1f0, 0xed736104,
+		0xd5620ea8, 0x2cf9dff9, 0x14e8b055, 0x5cdb00a1, 0x64ca6f0d,
+		0xccbc6149, 0xf4ad0ee5, 0xbc9ebe11, 0x848fd1bd, 0xe99ed468,
+		0xd18fbbc4, 0x99bc0b30, 0xa1ad649c, 0x09db6ad8, 0x31ca0574,
+		0x79f9b580, 0x41e8da2c, 0xa3dbbe2a, 0x9bcad186, 0xd3f96172,
+		0xebe80ede, 0x439e009a, 0x7b8f6f36, 0x33bcdfc2, 0x0badb06e,
+		0x66bcb5bb, 0x5eadda17, 0x169e6ae3, 0x2e8f054f, 0x86f90b0b,
+		0xbee864a7, 0xf6dbd453, 0xcecabbff, 0x6ea2d55c, 0x56b3baf0,
+		0x1e800a04, 0x269165a8, 0x8ee76bec, 0xb6f60440, 0xfec5b4b4,
+		0xc6d4db18, 0xabc5decd, 0x93d4b161, 0xdbe70195, 0xe3f66e39,
+		0x4b80607d, 0x73910fd1, 0x3ba2bf25, 0x03b3d089, 0xe180b48f,
+		0xd991db23, 0x91a26bd7, 0xa9b3047b, 0x01c50a3f, 0x39d46593,
+		0x71e7d567, 0x49f6bacb, 0x24e7bf1e, 0x1cf6d0b2, 0x54c56046,
+		0x6cd40fea, 0xc4a201ae, 0xfcb36e02, 0xb480def6, 0x8c91b15a,
+		0x750a600b, 0x4d1b0fa7, 0x0528bf53, 0x3d39d0ff, 0x954fdebb,
+		0xad5eb117, 0xe56d01e3, 0xdd7c6e4f, 0xb06d6b9a, 0x887c0436,
+		0xc04fb4c2, 0xf85edb6e, 0x5028d52a, 0x6839ba86, 0x200a0a72,
+		0x181b65de, 0xfa2801d8, 0xc2396e74, 0x8a0ade80, 0xb21bb12c,
+		0x1a6dbf68, 0x227cd0c4, 0x6a4f6030, 0x525e0f9c, 0x3f4f0a49,
+		0x075e65e5, 0x4f6dd511, 0x777cbabd, 0xdf0ab4f9, 0xe71bdb55,
+		0xaf286ba1, 0x9739040d, 0x59f3bff2, 0x61e2d05e, 0x29d160aa,
+		0x11c00f06, 0xb9b60142, 0x81a76eee, 0xc994de1a, 0xf185b1b6,
+		0x9c94b463, 0xa485dbcf, 0xecb66b3b, 0xd4a70497, 0x7cd10ad3,
+		0x44c0657f, 0x0cf3d58b, 0x34e2ba27, 0xd6d1de21, 0xeec0b18d,
+		0xa6f30179, 0x9ee26ed5, 0x36946091, 0x0e850f3d, 0x46b6bfc9,
+		0x7ea7d065, 0x13b6d5b0, 0x2ba7ba1c, 0x63940ae8, 0x5b856544,
+		0xf3f36b00, 0xcbe204ac, 0x83d1b458, 0xbbc0dbf4, 0x425b0aa5,
+		0x7a4a6509, 0x3279d5fd, 0x0a68ba51, 0xa21eb415, 0x9a0fdbb9,
+		0xd23c6b4d, 0xea2d04e1, 0x873c0134, 0xbf2d6e98, 0xf71ede6c,
+		0xcf0fb1c0, 0x6779bf84, 0x5f68d028, 0x175b60dc, 0x2f4a0f70,
+		0xcd796b76, 0xf56804da, 0xbd5bb42e, 0x854adb82, 0x2d3cd5c6,
+		0x152dba6a, 0x5d1e0a9e, 0x650f6532, 0x081e60e7, 0x300f0f4b,
+		0x783cbfbf, 0x402dd013, 0xe85bde57, 0xd04ab1fb, 0x9879010f,
+		0xa0686ea3
+	},
+	{
+		0x00000000, 0xef306b19, 0xdb8ca0c3, 0x34bccbda, 0xb2f53777,
+		0x5dc55c6e, 0x697997b4, 0x8649fcad, 0x6006181f, 0x8f367306,
+		0xbb8ab8dc, 0x54bad3c5, 0xd2f32f68, 0x3dc34471, 0x097f8fab,
+		0xe64fe4b2, 0xc00c303e, 0x2f3c5b27, 0x1b8090fd, 0xf4b0fbe4,
+		0x72f90749, 0x9dc96c50, 0xa975a78a, 0x4645cc93, 0xa00a2821,
+		0x4f3a4338, 0x7b8688e2, 0x94b6e3fb, 0x12ff1f56, 0xfdcf744f,
+		0xc973bf95, 0x2643d48c, 0x85f4168d, 0x6ac47d94, 0x5e78b64e,
+		0xb148dd57, 0x370121fa, 0xd8314ae3, 0xec8d8139, 0x03bdea20,
+		0xe5f20e92, 0x0ac2658b, 0x3e7eae51, 0xd14ec548, 0x570739e5,
+		0xb83752fc, 0x8c8b9926, 0x63bbf23f, 0x45f826b3, 0xaac84daa,
+		0x9e748670, 0x7144ed69, 0xf70d11c4, 0x183d7add, 0x2c81b107,
+		0xc3b1da1e, 0x25fe3eac, 0xcace55b5, 0xfe729e6f, 0x1142f576,
+		0x970b09db, 0x783b62c2, 0x4c87a918, 0xa3b7c201, 0x0e045beb,
+		0xe13430f2, 0xd588fb28, 0x3ab89031, 0xbcf16c9c, 0x53c10785,
+		0x677dcc5f, 0x884da746, 0x6e0243f4, 0x813228ed, 0xb58ee337,
+		0x5abe882e, 0xdcf77483, 0x33c71f9a, 0x077bd440, 0xe84bbf59,
+		0xce086bd5, 0x213800cc, 0x1584cb16, 0xfab4a00f, 0x7cfd5ca2,
+		0x93cd37bb, 0xa771fc61, 0x48419778, 0xae0e73ca, 0x413e18d3,
+		0x7582d309, 0x9ab2b810, 0x1cfb44bd, 0xf3cb2fa4, 0xc777e47e,
+		0x28478f67, 0x8bf04d66, 0x64c0267f, 0x507ceda5, 0xbf4c86bc,
+		0x39057a11, 0xd6351108, 0xe289dad2, 0x0db9b1cb, 0xebf65579,
+		0x04c63e60, 0x307af5ba, 0xdf4a9ea3, 0x5903620e, 0xb6330917,
+		0x828fc2cd, 0x6dbfa9d4, 0x4bfc7d58, 0xa4cc1641, 0x9070dd9b,
+		0x7f40b682, 0xf9094a2f, 0x16392136, 0x2285eaec, 0xcdb581f5,
+		0x2bfa6547, 0xc4ca0e5e, 0xf076c584, 0x1f46ae9d, 0x990f5230,
+		0x763f3929, 0x4283f2f3, 0xadb399ea, 0x1c08b7d6, 0xf338dccf,
+		0xc7841715, 0x28b47c0c, 0xaefd80a1, 0x41cdebb8, 0x75712062,
+		0x9a414b7b, 0x7c0eafc9, 0x933ec4d0, 0xa7820f0a, 0x48b26413,
+		0xcefb98be, 0x21cbf3a7, 0x1577387d, 0xfa475364, 0xdc0487e8,
+		0x3334ecf1, 0x0788272b, 0xe8b84c32, 0x6ef1b09f, 0x81c1db86,
+		0xb57d105c, 0x5a4d7b45, 0xbc029ff7, 0x5332f4ee, 0x678e3f34,
+		0x88be542d, 0x0ef7a880, 0xe1c7c399, 0xd57b0843, 0x3a4b635a,
+		0x99fca15b, 0x76ccca42, 0x42700198, 0xad406a81, 0x2b09962c,
+		0xc439fd35, 0xf08536ef, 0x1fb55df6, 0xf9fab944, 0x16cad25d,
+		0x22761987, 0xcd46729e, 0x4b0f8e33, 0xa43fe52a, 0x90832ef0,
+		0x7fb345e9, 0x59f09165, 0xb6c0fa7c, 0x827c31a6, 0x6d4c5abf,
+		0xeb05a612, 0x0435cd0b, 0x308906d1, 0xdfb96dc8, 0x39f6897a,
+		0xd6c6e263, 0xe27a29b9, 0x0d4a42a0, 0x8b03be0d, 0x6433d514,
+		0x508f1ece, 0xbfbf75d7, 0x120cec3d, 0xfd3c8724, 0xc9804cfe,
+		0x26b027e7, 0xa0f9db4a, 0x4fc9b053, 0x7b757b89, 0x94451090,
+		0x720af422, 0x9d3a9f3b, 0xa98654e1, 0x46b63ff8, 0xc0ffc355,
+		0x2fcfa84c, 0x1b736396, 0xf443088f, 0xd200dc03, 0x3d30b71a,
+		0x098c7cc0, 0xe6bc17d9, 0x60f5eb74, 0x8fc5806d, 0xbb794bb7,
+		0x544920ae, 0xb206c41c, 0x5d36af05, 0x698a64df, 0x86ba0fc6,
+		0x00f3f36b, 0xefc39872, 0xdb7f53a8, 0x344f38b1, 0x97f8fab0,
+		0x78c891a9, 0x4c745a73, 0xa344316a, 0x250dcdc7, 0xca3da6de,
+		0xfe816d04, 0x11b1061d, 0xf7fee2af, 0x18ce89b6, 0x2c72426c,
+		0xc3422975, 0x450bd5d8, 0xaa3bbec1, 0x9e87751b, 0x71b71e02,
+		0x57f4ca8e, 0xb8c4a197, 0x8c786a4d, 0x63480154, 0xe501fdf9,
+		0x0a3196e0, 0x3e8d5d3a, 0xd1bd3623, 0x37f2d291, 0xd8c2b988,
+		0xec7e7252, 0x034e194b, 0x8507e5e6, 0x6a378eff, 0x5e8b4525,
+		0xb1bb2e3c
+	},
+	{
+		0x00000000, 0x68032cc8, 0xd0065990, 0xb8057558, 0xa5e0c5d1,
+		0xcde3e919, 0x75e69c41, 0x1de5b089, 0x4e2dfd53, 0x262ed19b,
+		0x9e2ba4c3, 0xf628880b, 0xebcd3882, 0x83ce144a, 0x3bcb6112,
+		0x53c84dda, 0x9c5bfaa6, 0xf458d66e, 0x4c5da336, 0x245e8ffe,
+		0x39bb3f77, 0x51b813bf, 0xe9bd66e7, 0x81be4a2f, 0xd27607f5,
+		0xba752b3d, 0x02705e65, 0x6a7372ad, 0x7796c224, 0x1f95eeec,
+		0xa7909bb4, 0xcf93b77c, 0x3d5b83bd, 0x5558af75, 0xed5dda2d,
+		0x855ef6e5, 0x98bb466c, 0xf0b86aa4, 0x48bd1ffc, 0x20be3334,
+		0x73767eee, 0x1b755226, 0xa370277e, 0xcb730bb6, 0xd696bb3f,
+		0xbe9597f7, 0x0690e2af, 0x6e93ce67, 0xa100791b, 0xc90355d3,
+		0x7106208b, 0x19050c43, 0x04e0bcca, 0x6ce39002, 0xd4e6e55a,
+		0xbce5c992, 0xef2d8448, 0x872ea880, 0x3f2bddd8, 0x5728f110,
+		0x4acd4199, 0x22ce6d51, 0x9acb1809, 0xf2c834c1, 0x7ab7077a,
+		0x12b42bb2, 0xaab15eea, 0xc2b27222, 0xdf57c2ab, 0xb754ee63,
+		0x0f519b3b, 0x6752b7f3, 0x349afa29, 0x5c99d6e1, 0xe49ca3b9,
+		0x8c9f8f71, 0x917a3ff8, 0xf9791330, 0x417c6668, 0x297f4aa0,
+		0xe6ecfddc, 0x8eefd114, 0x36eaa44c, 0x5ee98884, 0x430c380d,
+		0x2b0f14c5, 0x930a619d, 0xfb094d55, 0xa8c1008f, 0xc0c22c47,
+		0x78c7591f, 0x10c475d7, 0x0d21c55e, 0x6522e996, 0xdd279cce,
+		0xb524b006, 0x47ec84c7, 0x2fefa80f, 0x97eadd57, 0xffe9f19f,
+		0xe20c4116, 0x8a0f6dde, 0x320a1886, 0x5a09344e, 0x09c17994,
+		0x61c2555c, 0xd9c72004, 0xb1c40ccc, 0xac21bc45, 0xc422908d,
+		0x7c27e5d5, 0x1424c91d, 0xdbb77e61, 0xb3b452a9, 0x0bb127f1,
+		0x63b20b39, 0x7e57bbb0, 0x16549778, 0xae51e220, 0xc652cee8,
+		0x959a8332, 0xfd99affa, 0x459cdaa2, 0x2d9ff66a, 0x307a46e3,
+		0x58796a2b, 0xe07c1f73, 0x887f33bb, 0xf56e0ef4, 0x9d6d223c,
+		0x25685764, 0x4d6b7bac, 0x508ecb25, 0x388de7ed, 0x808892b5,
+		0xe88bbe7d, 0xbb43f3a7, 0xd340df6f, 0x6b45aa37, 0x034686ff,
+		0x1ea33676, 0x76a01abe, 0xcea56fe6, 0xa6a6432e, 0x6935f452,
+		0x0136d89a, 0xb933adc2, 0xd130810a, 0xccd53183, 0xa4d61d4b,
+		0x1cd36813, 0x74d044db, 0x27180901, 0x4f1b25c9, 0xf71e5091,
+		0x9f1d7c59, 0x82f8ccd0, 0xeafbe018, 0x52fe9540, 0x3afdb988,
+		0xc8358d49, 0xa036a181, 0x1833d4d9, 0x7030f811, 0x6dd54898,
+		0x05d66450, 0xbdd31108, 0xd5d03dc0, 0x8618701a, 0xee1b5cd2,
+		0x561e298a, 0x3e1d0542, 0x23f8b5cb, 0x4bfb9903, 0xf3feec5b,
+		0x9bfdc093, 0x546e77ef, 0x3c6d5b27, 0x84682e7f, 0xec6b02b7,
+		0xf18eb23e, 0x998d9ef6, 0x2188ebae, 0x498bc766, 0x1a438abc,
+		0x7240a674, 0xca45d32c, 0xa246ffe4, 0xbfa34f6d, 0xd7a063a5,
+		0x6fa516fd, 0x07a63a35, 0x8fd9098e, 0xe7da2546, 0x5fdf501e,
+		0x37dc7cd6, 0x2a39cc5f, 0x423ae097, 0xfa3f95cf, 0x923cb907,
+		0xc1f4f4dd, 0xa9f7d815, 0x11f2ad4d, 0x79f18185, 0x6414310c,
+		0x0c171dc4, 0xb412689c, 0xdc114454, 0x1382f328, 0x7b81dfe0,
+		0xc384aab8, 0xab878670, 0xb66236f9, 0xde611a31, 0x66646f69,
+		0x0e6743a1, 0x5daf0e7b, 0x35ac22b3, 0x8da957eb, 0xe5aa7b23,
+		0xf84fcbaa, 0x904ce762, 0x2849923a, 0x404abef2, 0xb2828a33,
+		0xda81a6fb, 0x6284d3a3, 0x0a87ff6b, 0x17624fe2, 0x7f61632a,
+		0xc7641672, 0xaf673aba, 0xfcaf7760, 0x94ac5ba8, 0x2ca92ef0,
+		0x44aa0238, 0x594fb2b1, 0x314c9e79, 0x8949eb21, 0xe14ac7e9,
+		0x2ed97095, 0x46da5c5d, 0xfedf2905, 0x96dc05cd, 0x8b39b544,
+		0xe33a998c, 0x5b3fecd4, 0x333cc01c, 0x60f48dc6, 0x08f7a10e,
+		0xb0f2d456, 0xd8f1f89e, 0xc5144817, 0xad1764df, 0x15121187,
+		0x7d113d4f
+	},
+	{
+		0x00000000, 0x493c7d27, 0x9278fa4e, 0xdb448769, 0x211d826d,
+		0x6821ff4a, 0xb3657823, 0xfa590504, 0x423b04da, 0x0b0779fd,
+		0xd043fe94, 0x997f83b3, 0x632686b7, 0x2a1afb90, 0xf15e7cf9,
+		0xb86201de, 0x847609b4, 0xcd4a7493, 0x160ef3fa, 0x5f328edd,
+		0xa56b8bd9, 0xec57f6fe, 0x37137197, 0x7e2f0cb0, 0xc64d0d6e,
+		0x8f717049, 0x5435f720, 0x1d098a07, 0xe7508f03, 0xae6cf224,
+		0x7528754d, 0x3c14086a, 0x0d006599, 0x443c18be, 0x9f789fd7,
+		0xd644e2f0, 0x2c1de7f4, 0x65219ad3, 0xbe651dba, 0xf759609d,
+		0x4f3b6143, 0x06071c64, 0xdd439b0d, 0x947fe62a, 0x6e26e32e,
+		0x271a9e09, 0xfc5e1960, 0xb5626447, 0x89766c2d, 0xc04a110a,
+		0x1b0e9663, 0x5232eb44, 0xa86bee40, 0xe1579367, 0x3a13140e,
+		0x732f6929, 0xcb4d68f7, 0x827115d0, 0x593592b9, 0x1009ef9e,
+		0xea50ea9a, 0xa36c97bd, 0x782810d4, 0x31146df3, 0x1a00cb32,
+		0x533cb615, 0x8878317c, 0xc1444c5b, 0x3b1d495f, 0x72213478,
+		0xa965b311, 0xe059ce36, 0x583bcfe8, 0x1107b2cf, 0xca4335a6,
+		0x837f4881, 0x79264d85, 0x301a30a2, 0xeb5eb7cb, 0xa262caec,
+		0x9e76c286, 0xd74abfa1, 0x0c0e38c8, 0x453245ef, 0xbf6b40eb,
+		0xf6573dcc, 0x2d13baa5, 0x642fc782, 0xdc4dc65c, 0x9571bb7b,
+		0x4e353c12, 0x07094135, 0xfd504431, 0xb46c3916, 0x6f28be7f,
+		0x2614c358, 0x1700aeab, 0x5e3cd38c, 0x857854e5, 0xcc4429c2,
+		0x361d2cc6, 0x7f2151e1, 0xa465d688, 0xed59abaf, 0x553baa71,
+		0x1c07d756, 0xc743503f, 0x8e7f2d18, 0x7426281c, 0x3d1a553b,
+		0xe65ed252, 0xaf62af75, 0x9376a71f, 0xda4ada38, 0x010e5d51,
+		0x48322076, 0xb26b2572, 0xfb575855, 0x2013df3c, 0x692fa21b,
+		0xd14da3c5, 0x9871dee2, 0x4335598b, 0x0a0924ac, 0xf05021a8,
+		0xb96c5c8f, 0x6228dbe6, 0x2b14a6c1, 0x34019664, 0x7d3deb43,
+		0xa6796c2a, 0xef45110d, 0x151c1409, 0x5c20692e, 0x8764ee47,
+		0xce589360, 0x763a92be, 0x3f06ef99, 0xe44268f0, 0xad7e15d7,
+		0x572710d3, 0x1e1b6df4, 0xc55fea9d, 0x8c6397ba, 0xb0779fd0,
+		0xf94be2f7, 0x220f659e, 0x6b3318b9, 0x916a1dbd, 0xd856609a,
+		0x0312e7f3, 0x4a2e9ad4, 0xf24c9b0a, 0xbb70e62d, 0x60346144,
+		0x29081c63, 0xd3511967, 0x9a6d6440, 0x4129e329, 0x08159e0e,
+		0x3901f3fd, 0x703d8eda, 0xab7909b3, 0xe2457494, 0x181c7190,
+		0x51200cb7, 0x8a648bde, 0xc358f6f9, 0x7b3af727, 0x32068a00,
+		0xe9420d69, 0xa07e704e, 0x5a27754a, 0x131b086d, 0xc85f8f04,
+		0x8163f223, 0xbd77fa49, 0xf44b876e, 0x2f0f0007, 0x66337d20,
+		0x9c6a7824, 0xd5560503, 0x0e12826a, 0x472eff4d, 0xff4cfe93,
+		0xb67083b4, 0x6d3404dd, 0x240879fa, 0xde517cfe, 0x976d01d9,
+		0x4c2986b0, 0x0515fb97, 0x2e015d56, 0x673d2071, 0xbc79a718,
+		0xf545da3f, 0x0f1cdf3b, 0x4620a21c, 0x9d642575, 0xd4585852,
+		0x6c3a598c, 0x250624ab, 0xfe42a3c2, 0xb77edee5, 0x4d27dbe1,
+		0x041ba6c6, 0xdf5f21af, 0x96635c88, 0xaa7754e2, 0xe34b29c5,
+		0x380faeac, 0x7133d38b, 0x8b6ad68f, 0xc256aba8, 0x19122cc1,
+		0x502e51e6, 0xe84c5038, 0xa1702d1f, 0x7a34aa76, 0x3308d751,
+		0xc951d255, 0x806daf72, 0x5b29281b, 0x1215553c, 0x230138cf,
+		0x6a3d45e8, 0xb179c281, 0xf845bfa6, 0x021cbaa2, 0x4b20c785,
+		0x906440ec, 0xd9583dcb, 0x613a3c15, 0x28064132, 0xf342c65b,
+		0xba7ebb7c, 0x4027be78, 0x091bc35f, 0xd25f4436, 0x9b633911,
+		0xa777317b, 0xee4b4c5c, 0x350fcb35, 0x7c33b612, 0x866ab316,
+		0xcf56ce31, 0x14124958, 0x5d2e347f, 0xe54c35a1, 0xac704886,
+		0x7734cfef, 0x3e08b2c8, 0xc451b7cc, 0x8d6dcaeb, 0x56294d82,
+		0x1f1530a5
+	}
+};
+
+FORCE_INLINE unsigned int _mm_crc32_u8(unsigned int crc, unsigned char v)
+{
+	return (crc >> 8) ^ sse2msa_crc32c_table[0][(crc ^ v) & 0xff];
+}
+
+FORCE_INLINE unsigned int _mm_crc32_u16(unsigned int crc, unsigned short v)
+{
+	crc ^= v;
+	return (crc >> 16) ^ sse2msa_crc32c_table[1][crc & 0xff] ^
+		sse2msa_crc32c_table[0][(crc >> 8) & 0xff];
+}
+
+FORCE_INLINE unsigned int _mm_crc32_u32(unsigned int crc, unsigned int v)
+{
+	crc ^= v;
+	return sse2msa_crc32c_table[3][crc & 0xff] ^
+		sse2msa_crc32c_table[2][(crc >> 8) & 0xff] ^
+		sse2msa_crc32c_table[1][(crc >> 16) & 0xff] ^
+		sse2msa_crc32c_table[0][crc >> 24];
+}
+
+FORCE_INLINE unsigned long long _mm_crc32_u64(unsigned long long crc,
+					      unsigned long long v)
+{
+	uint32_t lo = (uint32_t)crc ^ (uint32_t)v, hi = v >> 32;
+	return sse2msa_crc32c_table[7][lo & 0xff] ^
+		sse2msa_crc32c_table[6][(lo >> 8) & 0xff] ^
+		sse2msa_crc32c_table[5][(lo >> 16) & 0xff] ^
+		sse2msa_crc32c_table[4][lo >> 24] ^
+		sse2msa_crc32c_table[3][hi & 0xff] ^
+		sse2msa_crc32c_table[2][(hi >> 8) & 0xff] ^
+		sse2msa_crc32c_table[1][(hi >> 16) & 0xff] ^
+		sse2msa_crc32c_table[0][hi >> 24];
+}
+#endif
+
+FORCE_INLINE uint64_t v_msa_load_le64(const unsigned char *p)
+{
+	uint64_t v;
+	__builtin_memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+/* crc * k mod P in the reflected domain; k = x^(8n) appends n zero bytes */
+FORCE_INLINE uint32_t v_msa_crc32c_shift(uint32_t crc, uint32_t k)
+{
+	uint32_t p = 0;
+	for (int i = 0; i < 32; i++) {
+		p ^= crc & -((k >> (31 - i)) & 1);
+		crc = (crc >> 1) ^ (SSE2MSA_CRC32C_POLY & -(crc & 1));
+	}
+	return p;
+}
+
+/* Three interleaved 2 KiB streams, x^(8 * 2048) and x^(8 * 4096) mod P */
+#define v_msa_crc32c_block 2048
+#define v_msa_crc32c_k1 0x0d65762au
+#define v_msa_crc32c_k2 0x35d73a62u
+
+/*
+ * CRC32-C of len bytes, continuing from seed exactly like a chain of
+ * _mm_crc32_u8 over buf. Large buffers are split into three independent
+ * streams so that consecutive crc32c (or table lookups) do not wait on
+ * each other, then recombined with two carry-less shifts.
+ */
+static inline uint32_t sse2msa_crc32c(const void *buf, size_t len,
+				      uint32_t seed)
+{
+	const unsigned char *p = (const unsigned char *)buf;
+	uint64_t crc = seed;
+
+	while (len >= 3 * v_msa_crc32c_block) {
+		uint64_t c1 = 0, c2 = 0;
+		for (size_t i = 0; i < v_msa_crc32c_block; i += 8) {
+			crc = _mm_crc32_u64(crc, v_msa_load_le64(p + i));
+			c1 = _mm_crc32_u64(c1,
+				v_msa_load_le64(p + v_msa_crc32c_block + i));
+			c2 = _mm_crc32_u64(c2,
+				v_msa_load_le64(p + 2 * v_msa_crc32c_block + i));
+		}
+		crc = v_msa_crc32c_shift(crc, v_msa_crc32c_k2) ^
+			v_msa_crc32c_shift(c1, v_msa_crc32c_k1) ^ c2;
+		p += 3 * v_msa_crc32c_block;
+		len -= 3 * v_msa_crc32c_block;
+	}
+	for (; len >= 8; p += 8, len -= 8)
+		crc = _mm_crc32_u64(crc, v_msa_load_le64(p));
+	for (; len; p++, len--)
+		crc = _mm_crc32_u8(crc, *p);
+	return crc;
+}
+
+/* Ref: wmmintrin.h
+ * AES rounds without data-dependent memory accesses, after Hamburg's
+ * vector-permute AES. A byte is mapped into GF((2^4)^2), with GF(2^4) =
+ * GF(2)[x]/(x^4 + x + 1) and the extension t^2 + 2t + 2, by two nibble
+ * lookups. It is inverted there with five 16-entry `vshf.b` lookups; 0x80
+ * stands for 1/0, and `vshf.b` turns it into zero. Two more lookups map
+ * the result back, with the (inverse) affine transform folded into the
+ * tables. ShiftRows is a single `vshf.b` and MixColumns rotates within
+ * columns with `shf.b`.
+ */
+#define v_msa_aes_inv 0
+#define v_msa_aes_ak 1
+#define v_msa_aes_enc 2
+#define v_msa_aes_dec 6
+
+static const uint8_t sse2msa_aes_tables[10][16] __attribute__((aligned(16))) = {
+	/* 1/x and 2/x in GF(2^4) */
+	{0x80, 0x01, 0x09, 0x0e, 0x0d, 0x0b, 0x07, 0x06,
+	 0x0f, 0x02, 0x0c, 0x05, 0x0a, 0x04, 0x03, 0x08},
+	{0x80, 0x02, 0x01, 0x0f, 0x09, 0x05, 0x0e, 0x0c,
+	 0x0d, 0x04, 0x0b, 0x0a, 0x07, 0x08, 0x06, 0x03},
+	/* encryption: input low/high nibble, output io/jo */
+	{0x00, 0x01, 0x1c, 0x1d, 0x2d, 0x2c, 0x31, 0x30,
+	 0x27, 0x26, 0x3b, 0x3a, 0x0a, 0x0b, 0x16, 0x17},
+	{0x00, 0x86, 0xfd, 0x7b, 0x8e, 0x08, 0x73, 0xf5,
+	 0x77, 0xf1, 0x8a, 0x0c, 0xf9, 0x7f, 0x04, 0x82},
+	{0x00, 0xcb, 0xd7, 0xb0, 0x21, 0x8d, 0x67, 0xac,
+	 0x7b, 0x5a, 0xea, 0x3d, 0x46, 0xf6, 0x91, 0x1c},
+	{0x00, 0x9f, 0x61, 0x16, 0xc2, 0x2a, 0x77, 0xe8,
+	 0x89, 0x4b, 0x5d, 0x3c, 0xb5, 0xa3, 0xd4, 0xfe},
+	/* decryption: same, inverse affine folded into the input */
+	{0x00, 0xb5, 0xdc, 0x69, 0xdb, 0x6e, 0x07, 0xb2,
+	 0x14, 0xa1, 0xc8, 0x7d, 0xcf, 0x7a, 0x13, 0xa6},
+	{0x2c, 0x8b, 0x84, 0x23, 0xc1, 0x66, 0x69, 0xce,
+	 0xfd, 0x5a, 0x55, 0xf2, 0x10, 0xb7, 0xb8, 0x1f},
+	{0x00, 0x3b, 0xe4, 0xc8, 0x03, 0x14, 0x2c, 0x17,
+	 0xf3, 0xf0, 0x38, 0xdc, 0x2f, 0xe7, 0xcb, 0xdf},
+	{0x00, 0x24, 0x91, 0x19, 0x23, 0x8f, 0x88, 0xac,
+	 0x3d, 0x1e, 0x07, 0x96, 0xab, 0xb2, 0x3a, 0xb5},
+};
+
+#define v_msa_aes_tab(n) \
+	__builtin_msa_ld_b((void *)sse2msa_aes_tables[n], 0)
+
+#define v_msa_aes_lut(n, x) \
+	__builtin_msa_vshf_b(x, v_msa_aes_tab(n), v_msa_aes_tab(n))
+
+/* SubBytes (tab = v_msa_aes_enc) or InvSubBytes (tab = v_msa_aes_dec) */
+FORCE_INLINE v16i8 v_msa_aes_sub(v16i8 x, const int tab)
+{
+	v16i8 i, j, k, ak, iak, jak;
+
+	x = v_msa_aes_lut(tab, vreinterpret_v16i8(
+		__builtin_msa_andi_b(vreinterpret_v16u8(x), 0x0f))) ^
+		v_msa_aes_lut(tab + 1, __builtin_msa_srli_b(x, 4));
+	i = __builtin_msa_srli_b(x, 4);
+	k = vreinterpret_v16i8(
+		__builtin_msa_andi_b(vreinterpret_v16u8(x), 0x0f));
+	ak = v_msa_aes_lut(v_msa_aes_ak, k);
+	j = i ^ k;
+	iak = v_msa_aes_lut(v_msa_aes_inv, i) ^ ak;
+	jak = v_msa_aes_lut(v_msa_aes_inv, j) ^ ak;
+	x = v_msa_aes_lut(tab + 2, v_msa_aes_lut(v_msa_aes_inv, iak) ^ j) ^
+		v_msa_aes_lut(tab + 3, v_msa_aes_lut(v_msa_aes_inv, jak) ^ i);
+	if (tab == v_msa_aes_enc)
+		x = vreinterpret_v16i8(
+			__builtin_msa_xori_b(vreinterpret_v16u8(x), 0x63));
+	return x;
+}
+
+FORCE_INLINE v16i8 v_msa_aes_shiftrows(v16i8 x, const int inv)
+{
+	VREG128 sr = {
+		.i8 = {0, 5, 10, 15, 4, 9, 14, 3,
+			8, 13, 2, 7, 12, 1, 6, 11}
+	};
+	VREG128 isr = {
+		.i8 = {0, 13, 10, 7, 4, 1, 14, 11,
+			8, 5, 2, 15, 12, 9, 6, 3}
+	};
+	return __builtin_msa_vshf_b(inv ? isr.msa_v16i8 : sr.msa_v16i8, x, x);
+}
+
+/* multiply every byte by x in GF(2^8) */
+FORCE_INLINE v16i8 v_msa_aes_xtime(v16i8 x)
+{
+	return __builtin_msa_slli_b(x, 1) ^ vreinterpret_v16i8(
+		__builtin_msa_andi_b(vreinterpret_v16u8(
+		__builtin_msa_clti_s_b(x, 0)), 0x1b));
+}
+
+/* r[i] = 2(a[i] ^ a[i+1]) ^ a[i+1] ^ a[i+2] ^ a[i+3] within each column */
+FORCE_INLINE v16i8 v_msa_aes_mixcolumns(v16i8 x)
+{
+	v16i8 r1 = __builtin_msa_shf_b(x, 0x39);
+	v16i8 t = x ^ r1;
+	return v_msa_aes_xtime(t) ^ r1 ^ __builtin_msa_shf_b(t, 0x4e);
+}
+
+/* InvMixColumns = MixColumns after a[i] ^= 4(a[i] ^ a[i+2]) */
+FORCE_INLINE v16i8 v_msa_aes_invmixcolumns(v16i8 x)
+{
+	v16i8 t = x ^ __builtin_msa_shf_b(x, 0x4e);
+	return v_msa_aes_mixcolumns(x ^ v_msa_aes_xtime(v_msa_aes_xtime(t)));
+}
+
+FORCE_INLINE __m128i _mm_aesenc_si128(__m128i a, __m128i RoundKey)
+{
+	v16i8 x = v_msa_aes_sub(
+		v_msa_aes_shiftrows(vreinterpret_v16i8(a), 0), v_msa_aes_enc);
+	return vreinterpret_m128i(v_msa_aes_mixcolumns(x) ^
+		vreinterpret_v16i8(RoundKey));
+}
+
+FORCE_INLINE __m128i _mm_aesenclast_si128(__m128i a, __m128i RoundKey)
+{
+	v16i8 x = v_msa_aes_sub(
+		v_msa_aes_shiftrows(vreinterpret_v16i8(a), 0), v_msa_aes_enc);
+	return vreinterpret_m128i(x ^ vreinterpret_v16i8(RoundKey));
+}
+
+FORCE_INLINE __m128i _mm_aesdec_si128(__m128i a, __m128i RoundKey)
+{
+	v16i8 x = v_msa_aes_sub(
+		v_msa_aes_shiftrows(vreinterpret_v16i8(a), 1), v_msa_aes_dec);
+	return vreinterpret_m128i(v_msa_aes_invmixcolumns(x) ^
+		vreinterpret_v16i8(RoundKey));
+}
+
+FORCE_INLINE __m128i _mm_aesdeclast_si128(__m128i a, __m128i RoundKey)
+{
+	v16i8 x = v_msa_aes_sub(
+		v_msa_aes_shiftrows(vreinterpret_v16i8(a), 1), v_msa_aes_dec);
+	return vreinterpret_m128i(x ^ vreinterpret_v16i8(RoundKey));
+}
+
+FORCE_INLINE __m128i _mm_aesimc_si128(__m128i a)
+{
+	return vreinterpret_m128i(
+		v_msa_aes_invmixcolumns(vreinterpret_v16i8(a)));
+}
+
+/* {SubWord(a1), RotWord(SubWord(a1)) ^ rcon, SubWord(a3), ...} */
+FORCE_INLINE __m128i _mm_aeskeygenassist_si128(__m128i a, const int imm8)
+{
+	VREG128 sel = {
+		.i8 = {4, 5, 6, 7, 5, 6, 7, 4,
+			12, 13, 14, 15, 13, 14, 15, 12}
+	};
+	v4i32 rcon = {0, imm8 & 0xff, 0, imm8 & 0xff};
+	v16i8 x = __builtin_msa_vshf_b(sel.msa_v16i8,
+		vreinterpret_v16i8(a), vreinterpret_v16i8(a));
+	return vreinterpret_m128i(vreinterpret_v4i32(
+		v_msa_aes_sub(x, v_msa_aes_enc)) ^ rcon);
+}
+
+/* One round over four independent blocks. Everything is inlined into a
+ * single block, so the four dependency chains interleave and the shared
+ * tables are loaded once.
+ */
+#define v_msa_aes_x4(name, fn)                                   \
+	FORCE_INLINE void name(__m128i *b, __m128i rk)           \
+	{                                                        \
+		b[0] = fn(b[0], rk);                             \
+		b[1] = fn(b[1], rk);                             \
+		b[2] = fn(b[2], rk);                             \
+		b[3] = fn(b[3], rk);                             \
+	}
+
+v_msa_aes_x4(sse2msa_aesenc_x4, _mm_aesenc_si128)
+v_msa_aes_x4(sse2msa_aesenclast_x4, _mm_aesenclast_si128)
+v_msa_aes_x4(sse2msa_aesdec_x4, _mm_aesdec_si128)
+v_msa_aes_x4(sse2msa_aesdeclast_x4, _mm_aesdeclast_si128)
+
+/* Full cipher over 4 or 8 blocks with an expanded schedule rk[0..rounds]
+ * (10, 12 or 14 rounds). Decryption takes the AES-NI style equivalent
+ * inverse schedule: reversed, with _mm_aesimc_si128 applied to the middle
+ * keys.
+ */
+#define v_msa_aes_cipher(name, n, fn, fnlast)                         \
+	FORCE_INLINE void name(__m128i *b, const __m128i *rk, int rounds) \
+	{                                                             \
+		for (int i = 0; i < n; i++)                           \
+			b[i] = _mm_xor_si128(b[i], rk[0]);            \
+		for (int r = 1; r < rounds; r++)                      \
+			for (int i = 0; i < n; i += 4)                \
+				fn(b + i, rk[r]);                     \
+		for (int i = 0; i < n; i += 4)                        \
+			fnlast(b + i, rk[rounds]);                    \
+	}
+
+v_msa_aes_cipher(sse2msa_aes_encrypt_x4, 4, sse2msa_aesenc_x4,
+		 sse2msa_aesenclast_x4)
+v_msa_aes_cipher(sse2msa_aes_encrypt_x8, 8, sse2msa_aesenc_x4,
+		 sse2msa_aesenclast_x4)
+v_msa_aes_cipher(sse2msa_aes_decrypt_x4, 4, sse2msa_aesdec_x4,
+		 sse2msa_aesdeclast_x4)
+v_msa_aes_cipher(sse2msa_aes_decrypt_x8, 8, sse2msa_aesdec_x4,
+		 sse2msa_aesdeclast_x4)
+
+/* Ref: wmmintrin.h
+ * Carry-less 64x64 -> 128 multiply, after Pornin's constant-time bmul64.
+ * Each operand is split into four planes holding every fourth bit. The
+ * integer product of two planes sums at most 15 terms into any bit it
+ * keeps, so no carry leaves its 4-bit hole. Sixteen `mulv.d` and four
+ * masks give the low 64 bits. The high 64 bits are the low half of the
+ * product of the bit-reversed operands, computed in lane 1 at the same
+ * time. Defining SSE2MSA_CLMUL_GPR on MIPS64 R6 runs the same algorithm
+ * on `dmul` and `dbitswap` in GPRs instead, for cores whose MSA
+ * multiplier is slow or shared.
+ */
+#define v_msa_bmul_mask(n) ((v2i64)(v2u64){ \
+	0x1111111111111111ull << (n), 0x1111111111111111ull << (n)})
+
+#define v_msa_bmul64_body(mul, x, y, m0, m1, m2, m3)                    \
+	do {                                                            \
+		__typeof__(x) x0 = x & m0, x1 = x & m1;                 \
+		__typeof__(x) x2 = x & m2, x3 = x & m3;                 \
+		__typeof__(y) y0 = y & m0, y1 = y & m1;                 \
+		__typeof__(y) y2 = y & m2, y3 = y & m3;                 \
+		x = (m0 & (mul(x0, y0) ^ mul(x1, y3) ^                  \
+			   mul(x2, y2) ^ mul(x3, y1))) |                \
+		    (m1 & (mul(x0, y1) ^ mul(x1, y0) ^                  \
+			   mul(x2, y3) ^ mul(x3, y2))) |                \
+		    (m2 & (mul(x0, y2) ^ mul(x1, y1) ^                  \
+			   mul(x2, y0) ^ mul(x3, y3))) |                \
+		    (m3 & (mul(x0, y3) ^ mul(x1, y2) ^                  \
+			   mul(x2, y1) ^ mul(x3, y0)));                 \
+	} while (0)
+
+#if defined(SSE2MSA_CLMUL_GPR) && defined(__mips64) && __mips_isa_rev >= 6
+#define v_msa_gpr_mul(x, y) ((x) * (y))
+
+FORCE_INLINE uint64_t v_msa_bmul64_gpr(uint64_t x, uint64_t y)
+{
+	v_msa_bmul64_body(v_msa_gpr_mul, x, y, 0x1111111111111111ull,
+		0x2222222222222222ull, 0x4444444444444444ull,
+		0x8888888888888888ull);
+	return x;
+}
+
+FORCE_INLINE uint64_t v_msa_rev64_gpr(uint64_t x)
+{
+	__asm__("dbitswap %0, %1" : "=r"(x) : "r"(x));
+	return __builtin_bswap64(x);
+}
+
+FORCE_INLINE __m128i _mm_clmulepi64_si128(__m128i a, __m128i b, const int imm8)
+{
+	v2i64 va = vreinterpret_v2i64(a), vb = vreinterpret_v2i64(b);
+	uint64_t x = imm8 & 1 ? __builtin_msa_copy_s_d(va, 1) :
+		__builtin_msa_copy_s_d(va, 0);
+	uint64_t y = imm8 & 0x10 ? __builtin_msa_copy_s_d(vb, 1) :
+		__builtin_msa_copy_s_d(vb, 0);
+	uint64_t hi = v_msa_rev64_gpr(v_msa_bmul64_gpr(v_msa_rev64_gpr(x),
+		v_msa_rev64_gpr(y))) >> 1;
+	return vreinterpret_m128i(__builtin_msa_insert_d(__builtin_msa_fill_d(
+		v_msa_bmul64_gpr(x, y)), 1, hi));
+}
+#else
+/* reverse the bits of each doubleword: bytes with `vshf.b`, then nibbles */
+FORCE_INLINE v2i64 v_msa_rev64(v2i64 x)
+{
+	VREG128 bswap = {
+		.i8 = {7, 6, 5, 4, 3, 2, 1, 0,
+			15, 14, 13, 12, 11, 10, 9, 8}
+	};
+	VREG128 rev = {
+		.i8 = {0x00, 0x08, 0x04, 0x0c, 0x02, 0x0a, 0x06, 0x0e,
+			0x01, 0x09, 0x05, 0x0d, 0x03, 0x0b, 0x07, 0x0f}
+	};
+	VREG128 revhi = {
+		.u8 = {0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0,
+			0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0}
+	};
+	v16i8 b = __builtin_msa_vshf_b(bswap.msa_v16i8,
+		vreinterpret_v16i8(x), vreinterpret_v16i8(x));
+	v16i8 lo = vreinterpret_v16i8(
+		__builtin_msa_andi_b(vreinterpret_v16u8(b), 0x0f));
+	return vreinterpret_v2i64(
+		__builtin_msa_vshf_b(lo, revhi.msa_v16i8, revhi.msa_v16i8) |
+		__builtin_msa_vshf_b(__builtin_msa_srli_b(b, 4),
+			rev.msa_v16i8, rev.msa_v16i8));
+}
+
+/* low 64 bits of the carry-less product in each lane */
+FORCE_INLINE v2i64 v_msa_bmul64(v2i64 x, v2i64 y)
+{
+	v_msa_bmul64_body(__builtin_msa_mulv_d, x, y,
+		v_msa_bmul_mask(0), v_msa_bmul_mask(1),
+		v_msa_bmul_mask(2), v_msa_bmul_mask(3));
+	return x;
+}
+
+FORCE_INLINE __m128i _mm_clmulepi64_si128(__m128i a, __m128i b, const int imm8)
+{
+	v2i64 va = vreinterpret_v2i64(a), vb = vreinterpret_v2i64(b);
+	v2i64 u, r, z;
+	if (imm8 & 0x01)
+		va = __builtin_msa_splati_d(va, 1);
+	if (imm8 & 0x10)
+		vb = __builtin_msa_splati_d(vb, 1);
+	/* lane 0 multiplies the reversed operands, lane 1 the plain ones */
+	u = __builtin_msa_ilvr_d(vb, va);
+	r = v_msa_rev64(u);
+	z = v_msa_bmul64(__builtin_msa_ilvr_d(u, r), __builtin_msa_ilvl_d(u, r));
+	r = __builtin_msa_srli_d(v_msa_rev64(z), 1);
+	return vreinterpret_m128i(__builtin_msa_sldi_b(
+		vreinterpret_v16i8(r), vreinterpret_v16i8(z), 8));
 }
+#endif
 
-FORCE_INLINE __m128i _mm_mullo_epi32(__m128i a, __m128i b)
+/*
+ * GHASH over len bytes of buf (a multiple of 16). The state y and the
+ * blocks are in GCM byte order, as are H and its powers in htab. Four
+ * blocks are multiplied by H^4 .. H (Karatsuba, three multiplies each)
+ * and summed before a single reduction.
+ */
+FORCE_INLINE __m128i v_msa_ghash_bswap(__m128i x)
 {
-	v4i32 z = v_msa_setzero(v4i32);
-	v2i64 eao = __builtin_msa_hadd_s_d(vreinterpret_v4i32(a), z);
-	v2i64 eae = __builtin_msa_hadd_s_d(z, vreinterpret_v4i32(a));
-	v2i64 ebo = __builtin_msa_hadd_s_d(vreinterpret_v4i32(b), z);
-	v2i64 ebe = __builtin_msa_hadd_s_d(z, vreinterpret_v4i32(b));
-	v2i64 vo = __builtin_msa_mulv_d(eao, ebo);
-	v2i64 ve = __builtin_msa_mulv_d(eae, ebe);
-	return vreinterpret_m128i(__builtin_msa_ilvev_w(
-		vreinterpret_v4i32(vo), vreinterpret_v4i32(ve)));
+	VREG128 rev = {
+		.i8 = {15, 14, 13, 12, 11, 10, 9, 8,
+			7, 6, 5, 4, 3, 2, 1, 0}
+	};
+	return vreinterpret_m128i(__builtin_msa_vshf_b(rev.msa_v16i8,
+		vreinterpret_v16i8(x), vreinterpret_v16i8(x)));
+}
+
+#define v_msa_ghash_load(p) \
+	v_msa_ghash_bswap(vreinterpret_m128i(__builtin_msa_ld_b((void *)(p), 0)))
+
+/* lo, mid, hi ^= the unreduced product a * b */
+#define v_msa_ghash_mul(lo, mid, hi, a, b)                               \
+	do {                                                             \
+		__m128i _a = (a), _b = (b);                              \
+		lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(_a, _b, 0x00)); \
+		hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(_a, _b, 0x11)); \
+		mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(           \
+			_mm_xor_si128(_a, _mm_shuffle_epi32(_a, 0x4e)),  \
+			_mm_xor_si128(_b, _mm_shuffle_epi32(_b, 0x4e)),  \
+			0x00));                                          \
+	} while (0)
+
+/* reduce hi:lo (bit-reflected) modulo x^128 + x^7 + x^2 + x + 1 */
+FORCE_INLINE __m128i v_msa_ghash_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+	__m128i t7, t8, t9;
+	mid = _mm_xor_si128(mid, _mm_xor_si128(lo, hi));
+	lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+	hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+	/* shift the 256-bit product left by one */
+	t7 = _mm_srli_epi64(lo, 63);
+	t8 = _mm_srli_epi64(hi, 63);
+	lo = _mm_or_si128(_mm_slli_epi64(lo, 1), _mm_slli_si128(t7, 8));
+	hi = _mm_or_si128(_mm_slli_epi64(hi, 1),
+		_mm_or_si128(_mm_slli_si128(t8, 8), _mm_srli_si128(t7, 8)));
+	t7 = _mm_xor_si128(_mm_slli_epi32(lo, 31),
+		_mm_xor_si128(_mm_slli_epi32(lo, 30), _mm_slli_epi32(lo, 25)));
+	t8 = _mm_srli_si128(t7, 4);
+	lo = _mm_xor_si128(lo, _mm_slli_si128(t7, 12));
+	t9 = _mm_xor_si128(_mm_srli_epi32(lo, 1),
+		_mm_xor_si128(_mm_srli_epi32(lo, 2), _mm_srli_epi32(lo, 7)));
+	return _mm_xor_si128(hi, _mm_xor_si128(lo, _mm_xor_si128(t9, t8)));
+}
+
+static inline void sse2msa_ghash_init(__m128i htab[4], __m128i h)
+{
+	__m128i z = _mm_setzero_si128(), lo, mid, hi;
+	htab[0] = v_msa_ghash_bswap(h);
+	for (int i = 1; i < 4; i++) {
+		lo = hi = mid = z;
+		v_msa_ghash_mul(lo, mid, hi, htab[i - 1], htab[0]);
+		htab[i] = v_msa_ghash_reduce(lo, mid, hi);
+	}
+	for (int i = 0; i < 4; i++)
+		htab[i] = v_msa_ghash_bswap(htab[i]);
+}
+
+static inline __m128i sse2msa_ghash(__m128i y, const __m128i htab[4],
+				    const void *buf, size_t len)
+{
+	const __m128i *p = (const __m128i *)buf;
+	__m128i h[4], z = _mm_setzero_si128();
+	for (int i = 0; i < 4; i++)
+		h[i] = v_msa_ghash_bswap(htab[i]);
+	y = v_msa_ghash_bswap(y);
+	for (; len >= 64; len -= 64, p += 4) {
+		__m128i lo = z, mid = z, hi = z;
+		v_msa_ghash_mul(lo, mid, hi, _mm_xor_si128(y,
+			v_msa_ghash_load(p)), h[3]);
+		v_msa_ghash_mul(lo, mid, hi,
+			v_msa_ghash_load(p + 1), h[2]);
+		v_msa_ghash_mul(lo, mid, hi,
+			v_msa_ghash_load(p + 2), h[1]);
+		v_msa_ghash_mul(lo, mid, hi,
+			v_msa_ghash_load(p + 3), h[0]);
+		y = v_msa_ghash_reduce(lo, mid, hi);
+	}
+	for (; len >= 16; len -= 16, p++) {
+		__m128i lo = z, mid = z, hi = z;
+		v_msa_ghash_mul(lo, mid, hi, _mm_xor_si128(y,
+			v_msa_ghash_load(p)), h[0]);
+		y = v_msa_ghash_reduce(lo, mid, hi);
+	}
+	return v_msa_ghash_bswap(y);
 }
 
-FORCE_INLINE __m128i _mm_mulhi_epi16(__m128i a, __m128i b)
-{
-	v8i16 z = v_msa_setzero(v8i16);
-	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
-	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
-	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
-	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
-	v4i32 vo = __builtin_msa_mulv_w(eao, ebo);
-	v4i32 ve = __builtin_msa_mulv_w(eae, ebe);
-	return vreinterpret_m128i(__builtin_msa_ilvod_h(
-		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
-}
+/* Ref: immintrin.h (SHA)
+ * The round intrinsics are sequential by nature. Their working variables
+ * are moved to GPRs once, the four (SHA-1) or two (SHA-256) rounds run
+ * there, and the result is packed back. The message schedule helpers stay
+ * in MSA, with rotates built from `slli`/`srli`/`or`.
+ */
+#define v_msa_rol32(x, n) ((uint32_t)(x) << (n) | (uint32_t)(x) >> (32 - (n)))
+#define v_msa_ror32(x, n) v_msa_rol32(x, 32 - (n))
 
-FORCE_INLINE __m128i _mm_mulhi_epu16(__m128i a, __m128i b)
+#define v_msa_rol_w(x, n) \
+	(__builtin_msa_slli_w(x, n) | __builtin_msa_srli_w(x, 32 - (n)))
+#define v_msa_ror_w(x, n) v_msa_rol_w(x, 32 - (n))
+
+FORCE_INLINE __m128i _mm_sha1msg1_epu32(__m128i a, __m128i b)
 {
-	v8u16 z = v_msa_setzero(v8u16);
-	v4u32 eao = __builtin_msa_hadd_u_w(vreinterpret_v8u16(a), z);
-	v4u32 eae = __builtin_msa_hadd_u_w(z, vreinterpret_v8u16(a));
-	v4u32 ebo = __builtin_msa_hadd_u_w(vreinterpret_v8u16(b), z);
-	v4u32 ebe = __builtin_msa_hadd_u_w(z, vreinterpret_v8u16(b));
-	v4i32 vo = __builtin_msa_mulv_w((v4i32)eao, (v4i32)ebo);
-	v4i32 ve = __builtin_msa_mulv_w((v4i32)eae, (v4i32)ebe);
-	return vreinterpret_m128i(__builtin_msa_ilvod_h(
-		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+	/* {b2, b3, a0, a1} */
+	return vreinterpret_m128i(vreinterpret_v16i8(a) ^ __builtin_msa_sldi_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b), 8));
 }
 
-FORCE_INLINE __m64 _mm_mullo_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m128i _mm_sha1msg2_epu32(__m128i a, __m128i b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_mullo_epi16(va.m128i, vb.m128i)
-	};
-	return v.m64[0];
+	v16i8 z = __builtin_msa_ldi_b(0);
+	/* W16..W18 from a ^ {0, b0, b1, b2}; W19 also needs W16 */
+	v4i32 t = vreinterpret_v4i32(vreinterpret_v16i8(a) ^
+		__builtin_msa_sldi_b(vreinterpret_v16i8(b), z, 12));
+	t = v_msa_rol_w(t, 1);
+	return vreinterpret_m128i(t ^ v_msa_rol_w(vreinterpret_v4i32(
+		__builtin_msa_sldi_b(z, vreinterpret_v16i8(t), 12)), 1));
 }
 
-FORCE_INLINE __m64 _mm_mulhi_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m128i _mm_sha1nexte_epu32(__m128i a, __m128i b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_mulhi_epi16(va.m128i, vb.m128i)
-	};
-	return v.m64[0];
+	v4i32 e = v_msa_rol_w(vreinterpret_v4i32(a), 30) & (v4i32){0, 0, 0, -1};
+	return vreinterpret_m128i(vreinterpret_v4i32(b) + e);
 }
 
-FORCE_INLINE __m64 _mm_mulhi_pu16(__m64 a, __m64 b)
+FORCE_INLINE __m128i _mm_sha1rnds4_epu32(__m128i a, __m128i b, const int func)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_mulhi_epu16(va.m128i, vb.m128i)
+	static const uint32_t k[4] = {
+		0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xca62c1d6
+	};
+	v4i32 va = vreinterpret_v4i32(a), vb = vreinterpret_v4i32(b);
+	uint32_t w[4] = {
+		__builtin_msa_copy_s_w(vb, 3), __builtin_msa_copy_s_w(vb, 2),
+		__builtin_msa_copy_s_w(vb, 1), __builtin_msa_copy_s_w(vb, 0)
 	};
-	return v.m64[0];
+	uint32_t A = __builtin_msa_copy_s_w(va, 3);
+	uint32_t B = __builtin_msa_copy_s_w(va, 2);
+	uint32_t C = __builtin_msa_copy_s_w(va, 1);
+	uint32_t D = __builtin_msa_copy_s_w(va, 0), E = 0;
+	for (int i = 0; i < 4; i++) {
+		uint32_t f;
+		if ((func & 3) == 0)
+			f = (B & C) | (~B & D);
+		else if ((func & 3) == 2)
+			f = (B & C) | (B & D) | (C & D);
+		else
+			f = B ^ C ^ D;
+		f += v_msa_rol32(A, 5) + E + w[i] + k[func & 3];
+		E = D;
+		D = C;
+		C = v_msa_rol32(B, 30);
+		B = A;
+		A = f;
+	}
+	v4u32 r = {D, C, B, A};
+	return vreinterpret_m128i(r);
 }
 
-#define _m_pmulhuw(a, b) _mm_mulhi_pu16(a, b)
+#define v_msa_sha256_s0(x) \
+	(v_msa_ror_w(x, 7) ^ v_msa_ror_w(x, 18) ^ __builtin_msa_srli_w(x, 3))
+#define v_msa_sha256_s1(x) \
+	(v_msa_ror_w(x, 17) ^ v_msa_ror_w(x, 19) ^ __builtin_msa_srli_w(x, 10))
 
-FORCE_INLINE __m128i _mm_mulhrs_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m128i _mm_sha256msg1_epu32(__m128i a, __m128i b)
 {
-	v8i16 z = v_msa_setzero(v8i16);
-	v4i32 eao = __builtin_msa_hadd_s_w(vreinterpret_v8i16(a), z);
-	v4i32 eae = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(a));
-	v4i32 ebo = __builtin_msa_hadd_s_w(vreinterpret_v8i16(b), z);
-	v4i32 ebe = __builtin_msa_hadd_s_w(z, vreinterpret_v8i16(b));
-	v4i32 vo = __builtin_msa_srai_w(__builtin_msa_mulv_w(eao, ebo), 14) + 1;
-	v4i32 ve = __builtin_msa_srai_w(__builtin_msa_mulv_w(eae, ebe), 14) + 1;
-	vo = __builtin_msa_srli_w(vo, 1);
-	ve = __builtin_msa_srli_w(ve, 1);
-	return vreinterpret_m128i(__builtin_msa_ilvev_h(
-		vreinterpret_v8i16(vo), vreinterpret_v8i16(ve)));
+	/* {a1, a2, a3, b0} */
+	v4i32 t = vreinterpret_v4i32(__builtin_msa_sldi_b(
+		vreinterpret_v16i8(b), vreinterpret_v16i8(a), 4));
+	return vreinterpret_m128i(vreinterpret_v4i32(a) + v_msa_sha256_s0(t));
 }
 
-FORCE_INLINE __m64 _mm_mulhrs_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m128i _mm_sha256msg2_epu32(__m128i a, __m128i b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_mulhrs_epi16(va.m128i, vb.m128i)
+	v2i64 vb = vreinterpret_v2i64(b);
+	/* W16, W17 from b2, b3, then W18, W19 from W16, W17 */
+	v4i32 x = vreinterpret_v4i32(a) + v_msa_sha256_s1(
+		vreinterpret_v4i32(__builtin_msa_ilvl_d(vb, vb)));
+	v2i64 lo = vreinterpret_v2i64(x);
+	v4i32 y = vreinterpret_v4i32(a) + v_msa_sha256_s1(
+		vreinterpret_v4i32(__builtin_msa_ilvr_d(lo, lo)));
+	return vreinterpret_m128i(
+		__builtin_msa_insve_d(vreinterpret_v2i64(y), 0, lo));
+}
+
+#define v_msa_sha256_round(A, B, C, D, E, F, G, H, wk)                  \
+	do {                                                            \
+		uint32_t _t1 = H + (v_msa_ror32(E, 6) ^                 \
+			v_msa_ror32(E, 11) ^ v_msa_ror32(E, 25)) +      \
+			((E & F) ^ (~E & G)) + (wk);                    \
+		uint32_t _t2 = (v_msa_ror32(A, 2) ^ v_msa_ror32(A, 13) ^ \
+			v_msa_ror32(A, 22)) + ((A & B) ^ (A & C) ^ (B & C)); \
+		D += _t1;                                               \
+		H = _t1 + _t2;                                          \
+	} while (0)
+
+/* a = {H, G, D, C}, b = {F, E, B, A}; returns the new {F, E, B, A} */
+FORCE_INLINE __m128i _mm_sha256rnds2_epu32(__m128i a, __m128i b, __m128i k)
+{
+	v4i32 va = vreinterpret_v4i32(a), vb = vreinterpret_v4i32(b);
+	v4i32 vk = vreinterpret_v4i32(k);
+	uint32_t A = __builtin_msa_copy_s_w(vb, 3);
+	uint32_t B = __builtin_msa_copy_s_w(vb, 2);
+	uint32_t C = __builtin_msa_copy_s_w(va, 3);
+	uint32_t D = __builtin_msa_copy_s_w(va, 2);
+	uint32_t E = __builtin_msa_copy_s_w(vb, 1);
+	uint32_t F = __builtin_msa_copy_s_w(vb, 0);
+	uint32_t G = __builtin_msa_copy_s_w(va, 1);
+	uint32_t H = __builtin_msa_copy_s_w(va, 0);
+	v_msa_sha256_round(A, B, C, D, E, F, G, H,
+		(uint32_t)__builtin_msa_copy_s_w(vk, 0));
+	v_msa_sha256_round(H, A, B, C, D, E, F, G,
+		(uint32_t)__builtin_msa_copy_s_w(vk, 1));
+	v4u32 r = {D, C, H, G};
+	return vreinterpret_m128i(r);
+}
+
+/*
+ * Multi-buffer SHA-256: four independent messages hashed in lockstep, one
+ * per lane. state[i] holds working word i (a .. h) of all four hashes, lane
+ * j for message j. Each sse2msa_sha256_x4 call compresses one 64-byte block
+ * of every message, so padding is up to the caller.
+ */
+static const uint32_t sse2msa_sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/* rows r0..r3 become columns */
+#define v_msa_transpose4_w(r0, r1, r2, r3)                              \
+	do {                                                            \
+		v2i64 _t0 = vreinterpret_v2i64(__builtin_msa_ilvr_w(r1, r0)); \
+		v2i64 _t1 = vreinterpret_v2i64(__builtin_msa_ilvl_w(r1, r0)); \
+		v2i64 _t2 = vreinterpret_v2i64(__builtin_msa_ilvr_w(r3, r2)); \
+		v2i64 _t3 = vreinterpret_v2i64(__builtin_msa_ilvl_w(r3, r2)); \
+		r0 = vreinterpret_v4i32(__builtin_msa_ilvr_d(_t2, _t0));    \
+		r1 = vreinterpret_v4i32(__builtin_msa_ilvl_d(_t2, _t0));    \
+		r2 = vreinterpret_v4i32(__builtin_msa_ilvr_d(_t3, _t1));    \
+		r3 = vreinterpret_v4i32(__builtin_msa_ilvl_d(_t3, _t1));    \
+	} while (0)
+
+/* SHA-256 words are big-endian */
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define v_msa_bswap_w(x) (x)
+#else
+#define v_msa_bswap_w(x) \
+	vreinterpret_v4i32(__builtin_msa_shf_b(vreinterpret_v16i8(x), 0x1b))
+#endif
+
+#define v_msa_sel_w(m, s, t)                                            \
+	vreinterpret_v4i32(__builtin_msa_bsel_v(vreinterpret_v16u8(m),  \
+		vreinterpret_v16u8(s), vreinterpret_v16u8(t)))
+
+#define v_msa_sha256_round_x4(a, b, c, d, e, f, g, h, i)                \
+	do {                                                            \
+		if (r)                                                  \
+			w[i] += v_msa_sha256_s1(w[((i) + 14) & 15]) +   \
+				w[((i) + 9) & 15] +                     \
+				v_msa_sha256_s0(w[((i) + 1) & 15]);     \
+		v4i32 _t1 = h + (v_msa_ror_w(e, 6) ^ v_msa_ror_w(e, 11) ^ \
+			v_msa_ror_w(e, 25)) + v_msa_sel_w(e, g, f) +    \
+			__builtin_msa_fill_w(sse2msa_sha256_k[r + (i)]) + w[i]; \
+		d += _t1;                                               \
+		h = _t1 + (v_msa_ror_w(a, 2) ^ v_msa_ror_w(a, 13) ^     \
+			v_msa_ror_w(a, 22)) + v_msa_sel_w(a ^ b, a, c); \
+	} while (0)
+
+static inline void sse2msa_sha256_init_x4(__m128i state[8])
+{
+	static const uint32_t iv[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+		0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
 	};
-	return v.m64[0];
+	for (int i = 0; i < 8; i++)
+		state[i] = vreinterpret_m128i(__builtin_msa_fill_w(iv[i]));
+}
+
+static inline void sse2msa_sha256_x4(__m128i state[8],
+				     const void *const block[4])
+{
+	v4i32 w[16];
+	v4i32 a = vreinterpret_v4i32(state[0]), b = vreinterpret_v4i32(state[1]);
+	v4i32 c = vreinterpret_v4i32(state[2]), d = vreinterpret_v4i32(state[3]);
+	v4i32 e = vreinterpret_v4i32(state[4]), f = vreinterpret_v4i32(state[5]);
+	v4i32 g = vreinterpret_v4i32(state[6]), h = vreinterpret_v4i32(state[7]);
+	for (int i = 0; i < 16; i += 4) {
+		for (int j = 0; j < 4; j++)
+			w[i + j] = v_msa_bswap_w(__builtin_msa_ld_w(
+				(void *)((const char *)block[j] + 4 * i), 0));
+		v_msa_transpose4_w(w[i], w[i + 1], w[i + 2], w[i + 3]);
+	}
+	for (int r = 0; r < 64; r += 16) {
+		v_msa_sha256_round_x4(a, b, c, d, e, f, g, h, 0);
+		v_msa_sha256_round_x4(h, a, b, c, d, e, f, g, 1);
+		v_msa_sha256_round_x4(g, h, a, b, c, d, e, f, 2);
+		v_msa_sha256_round_x4(f, g, h, a, b, c, d, e, 3);
+		v_msa_sha256_round_x4(e, f, g, h, a, b, c, d, 4);
+		v_msa_sha256_round_x4(d, e, f, g, h, a, b, c, 5);
+		v_msa_sha256_round_x4(c, d, e, f, g, h, a, b, 6);
+		v_msa_sha256_round_x4(b, c, d, e, f, g, h, a, 7);
+		v_msa_sha256_round_x4(a, b, c, d, e, f, g, h, 8);
+		v_msa_sha256_round_x4(h, a, b, c, d, e, f, g, 9);
+		v_msa_sha256_round_x4(g, h, a, b, c, d, e, f, 10);
+		v_msa_sha256_round_x4(f, g, h, a, b, c, d, e, 11);
+		v_msa_sha256_round_x4(e, f, g, h, a, b, c, d, 12);
+		v_msa_sha256_round_x4(d, e, f, g, h, a, b, c, 13);
+		v_msa_sha256_round_x4(c, d, e, f, g, h, a, b, 14);
+		v_msa_sha256_round_x4(b, c, d, e, f, g, h, a, 15);
+	}
+	state[0] = vreinterpret_m128i(vreinterpret_v4i32(state[0]) + a);
+	state[1] = vreinterpret_m128i(vreinterpret_v4i32(state[1]) + b);
+	state[2] = vreinterpret_m128i(vreinterpret_v4i32(state[2]) + c);
+	state[3] = vreinterpret_m128i(vreinterpret_v4i32(state[3]) + d);
+	state[4] = vreinterpret_m128i(vreinterpret_v4i32(state[4]) + e);
+	state[5] = vreinterpret_m128i(vreinterpret_v4i32(state[5]) + f);
+	state[6] = vreinterpret_m128i(vreinterpret_v4i32(state[6]) + g);
+	state[7] = vreinterpret_m128i(vreinterpret_v4i32(state[7]) + h);
+}
+
+/* the 32-byte big-endian digest of message j to out[j] */
+static inline void sse2msa_sha256_digest_x4(const __m128i state[8],
+					    uint8_t out[4][32])
+{
+	for (int i = 0; i < 8; i += 4) {
+		v4i32 r[4];
+		for (int j = 0; j < 4; j++)
+			r[j] = vreinterpret_v4i32(state[i + j]);
+		v_msa_transpose4_w(r[0], r[1], r[2], r[3]);
+		for (int j = 0; j < 4; j++)
+			__builtin_msa_st_w(v_msa_bswap_w(r[j]), out[j] + 4 * i, 0);
+	}
 }
 
-FORCE_INLINE __m128i _mm_maddubs_epi16(__m128i a, __m128i b)
+/* Ref: immintrin.h (FMA)
+ * MSA `fmadd`/`fmsub` are fused and accumulate into their first operand:
+ * fmadd(c, a, b) = c + a * b, fmsub(c, a, b) = c - a * b, one rounding.
+ * The negated-addend forms flip the sign bit of c before the fused op
+ * instead of negating the result, so they round correctly in every mode.
+ * A NaN addend therefore comes back with its sign bit flipped.
+ */
+#define v_msa_fneg_w(x, m) vreinterpret_v4f32(vreinterpret_v4i32(x) ^ (m))
+#define v_msa_fneg_d(x, m) vreinterpret_v2f64(vreinterpret_v2i64(x) ^ (m))
+
+FORCE_INLINE __m128 _mm_fmadd_ps(__m128 a, __m128 b, __m128 c)
 {
-	v16u8 z = v_msa_setzero(v16u8);
-	v16i8 i = v_msa_setzero(v16i8);
-	v8u16 eao = __builtin_msa_hadd_u_h(vreinterpret_v16u8(a), z);
-	v8u16 eae = __builtin_msa_hadd_u_h(z, vreinterpret_v16u8(a));
-	v8i16 ebo = __builtin_msa_hadd_s_h(vreinterpret_v16i8(b), i);
-	v8i16 ebe = __builtin_msa_hadd_s_h(i, vreinterpret_v16i8(b));
-	v8i16 vo = __builtin_msa_mulv_h((v8i16)eao, ebo);
-	v8i16 ve = __builtin_msa_mulv_h((v8i16)eae, ebe);
-	return vreinterpret_m128i(__builtin_msa_adds_s_h(vo, ve));
+	return vreinterpret_m128(__builtin_msa_fmadd_w(vreinterpret_v4f32(c),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m64 _mm_maddubs_pi16(__m64 a, __m64 b)
+FORCE_INLINE __m128d _mm_fmadd_pd(__m128d a, __m128d b, __m128d c)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	VREG128 v = {
-		.m128i = _mm_maddubs_epi16(va.m128i, vb.m128i)
-	};
-	return v.m64[0];
+	return vreinterpret_m128d(__builtin_msa_fmadd_d(vreinterpret_v2f64(c),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-FORCE_INLINE __m128i _mm_madd_epi16(__m128i a, __m128i b)
+FORCE_INLINE __m128 _mm_fmadd_ss(__m128 a, __m128 b, __m128 c)
 {
-	VREG128 v = {
-		.i32 = {
-			(int32_t)vreinterpret_nth_i16_m128i(a, 0) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 0) +
-			(int32_t)vreinterpret_nth_i16_m128i(a, 1) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 1),
-			(int32_t)vreinterpret_nth_i16_m128i(a, 2) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 2) +
-			(int32_t)vreinterpret_nth_i16_m128i(a, 3) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 3),
-			(int32_t)vreinterpret_nth_i16_m128i(a, 4) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 4) +
-			(int32_t)vreinterpret_nth_i16_m128i(a, 5) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 5),
-			(int32_t)vreinterpret_nth_i16_m128i(a, 6) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 6) +
-			(int32_t)vreinterpret_nth_i16_m128i(a, 7) *
-			(int32_t)vreinterpret_nth_i16_m128i(b, 7),
-		}
-	};
-	return v.m128i;
+	return _mm_move_ss(a, _mm_fmadd_ps(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_addsub_ps(__m128 a, __m128 b)
+FORCE_INLINE __m128d _mm_fmadd_sd(__m128d a, __m128d b, __m128d c)
+{
+	return _mm_move_sd(a, _mm_fmadd_pd(a, b, c));
+}
+
+FORCE_INLINE __m128 _mm_fmsub_ps(__m128 a, __m128 b, __m128 c)
 {
-	v4f32 mask = {-1.0f, 1.0f, -1.0f, 1.0f};
 	return vreinterpret_m128(__builtin_msa_fmadd_w(
-		vreinterpret_v4f32(b), mask, vreinterpret_v4f32(a)));
+		v_msa_fneg_w(c, __builtin_msa_fill_w(INT32_MIN)),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m128d _mm_addsub_pd(__m128d a, __m128d b)
+FORCE_INLINE __m128d _mm_fmsub_pd(__m128d a, __m128d b, __m128d c)
 {
-	v2f64 mask = {-1.0f, 1.0f};
 	return vreinterpret_m128d(__builtin_msa_fmadd_d(
-		vreinterpret_v2f64(b), mask, vreinterpret_v2f64(a)));
+		v_msa_fneg_d(c, __builtin_msa_fill_d(INT64_MIN)),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-FORCE_INLINE __m128 _mm_div_ps(__m128 a, __m128 b)
+FORCE_INLINE __m128 _mm_fmsub_ss(__m128 a, __m128 b, __m128 c)
 {
-	return vreinterpret_m128(__builtin_msa_fdiv_w(
-		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
+	return _mm_move_ss(a, _mm_fmsub_ps(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_div_ss(__m128 a, __m128 b)
+FORCE_INLINE __m128d _mm_fmsub_sd(__m128d a, __m128d b, __m128d c)
 {
-	return _mm_move_ss(a, _mm_div_ps(a, b));
+	return _mm_move_sd(a, _mm_fmsub_pd(a, b, c));
 }
 
-FORCE_INLINE __m128d _mm_div_pd(__m128d a, __m128d b)
+FORCE_INLINE __m128 _mm_fnmadd_ps(__m128 a, __m128 b, __m128 c)
 {
-	return vreinterpret_m128d(__builtin_msa_fdiv_d(
-		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
+	return vreinterpret_m128(__builtin_msa_fmsub_w(vreinterpret_v4f32(c),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m128d _mm_div_sd(__m128d a, __m128d b)
+FORCE_INLINE __m128d _mm_fnmadd_pd(__m128d a, __m128d b, __m128d c)
 {
-	return _mm_move_sd(a, _mm_div_pd(a, b));
+	return vreinterpret_m128d(__builtin_msa_fmsub_d(vreinterpret_v2f64(c),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-FORCE_INLINE __m128 _mm_rcp_ps(__m128 a)
+FORCE_INLINE __m128 _mm_fnmadd_ss(__m128 a, __m128 b, __m128 c)
 {
-	return vreinterpret_m128(
-		__builtin_msa_frcp_w(vreinterpret_v4f32(a)));
+	return _mm_move_ss(a, _mm_fnmadd_ps(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_rcp_ss(__m128 a)
+FORCE_INLINE __m128d _mm_fnmadd_sd(__m128d a, __m128d b, __m128d c)
 {
-	return _mm_move_ss(a, _mm_rcp_ps(a));
+	return _mm_move_sd(a, _mm_fnmadd_pd(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_sqrt_ps(__m128 a)
+FORCE_INLINE __m128 _mm_fnmsub_ps(__m128 a, __m128 b, __m128 c)
 {
-	return vreinterpret_m128(
-		__builtin_msa_fsqrt_w(vreinterpret_v4f32(a)));
+	return vreinterpret_m128(__builtin_msa_fmsub_w(
+		v_msa_fneg_w(c, __builtin_msa_fill_w(INT32_MIN)),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m128d _mm_sqrt_pd(__m128d a)
+FORCE_INLINE __m128d _mm_fnmsub_pd(__m128d a, __m128d b, __m128d c)
 {
-	return vreinterpret_m128d(
-		__builtin_msa_fsqrt_d(vreinterpret_v2f64(a)));
+	return vreinterpret_m128d(__builtin_msa_fmsub_d(
+		v_msa_fneg_d(c, __builtin_msa_fill_d(INT64_MIN)),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-FORCE_INLINE __m128d _mm_sqrt_sd(__m128d a, __m128d b)
+FORCE_INLINE __m128 _mm_fnmsub_ss(__m128 a, __m128 b, __m128 c)
 {
-    return _mm_move_sd(a, _mm_sqrt_pd(b));
+	return _mm_move_ss(a, _mm_fnmsub_ps(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_sqrt_ss(__m128 a)
+FORCE_INLINE __m128d _mm_fnmsub_sd(__m128d a, __m128d b, __m128d c)
 {
-	return _mm_move_ss(a, _mm_sqrt_ps(a));
+	return _mm_move_sd(a, _mm_fnmsub_pd(a, b, c));
 }
 
-FORCE_INLINE __m128 _mm_rsqrt_ps(__m128 a)
+/* even lanes a * b - c, odd lanes a * b + c */
+FORCE_INLINE __m128 _mm_fmaddsub_ps(__m128 a, __m128 b, __m128 c)
 {
-	return vreinterpret_m128(
-		__builtin_msa_frsqrt_w(vreinterpret_v4f32(a)));
+	const v4i32 m = { INT32_MIN, 0, INT32_MIN, 0 };
+
+	return vreinterpret_m128(__builtin_msa_fmadd_w(
+		v_msa_fneg_w(c, m),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE __m128 _mm_rsqrt_ss(__m128 a)
+FORCE_INLINE __m128d _mm_fmaddsub_pd(__m128d a, __m128d b, __m128d c)
 {
-	return _mm_move_ss(a, _mm_rsqrt_ps(a));
+	const v2i64 m = { INT64_MIN, 0 };
+
+	return vreinterpret_m128d(__builtin_msa_fmadd_d(
+		v_msa_fneg_d(c, m),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
-int _mm_popcnt_u32(unsigned int a)
+/* even lanes a * b + c, odd lanes a * b - c */
+FORCE_INLINE __m128 _mm_fmsubadd_ps(__m128 a, __m128 b, __m128 c)
 {
-	VREG128 v = {.u32 = {a, 0, 0, 0}};
-	v.msa_v4i32 = __builtin_msa_pcnt_w(v.msa_v4i32);
-	return v.i32[0];
+	const v4i32 m = { 0, INT32_MIN, 0, INT32_MIN };
+
+	return vreinterpret_m128(__builtin_msa_fmadd_w(
+		v_msa_fneg_w(c, m),
+		vreinterpret_v4f32(a), vreinterpret_v4f32(b)));
 }
 
-FORCE_INLINE int64_t _mm_popcnt_u64(uint64_t a)
+FORCE_INLINE __m128d _mm_fmsubadd_pd(__m128d a, __m128d b, __m128d c)
 {
-	VREG128 v = {.u64 = {a, 0}};
-	v.msa_v2i64 = __builtin_msa_pcnt_d(v.msa_v2i64);
-	return v.i64[0];
+	const v2i64 m = { 0, INT64_MIN };
+
+	return vreinterpret_m128d(__builtin_msa_fmadd_d(
+		v_msa_fneg_d(c, m),
+		vreinterpret_v2f64(a), vreinterpret_v2f64(b)));
 }
 
 FORCE_INLINE __m128 _mm_max_ps(__m128 a, __m128 b)
@@ -2223,10 +4309,8 @@ FORCE_INLINE __m128i _mm_max_epu8(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_max_pu8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.msa_v16u8 = __builtin_msa_max_u_b(va.msa_v16u8, vb.msa_v16u8);
-	return va.m64[0];
+	return v_msa_copy_m64(__builtin_msa_max_u_b(
+		v_msa_fill_m64(v16u8, a), v_msa_fill_m64(v16u8, b)));
 }
 
 #define _m_pmaxub(a, b) _mm_max_pu8(a, b)
@@ -2239,10 +4323,8 @@ FORCE_INLINE __m128i _mm_min_epu8(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_min_pu8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.msa_v16u8 = __builtin_msa_min_u_b(va.msa_v16u8, vb.msa_v16u8);
-	return va.m64[0];
+	return v_msa_copy_m64(__builtin_msa_min_u_b(
+		v_msa_fill_m64(v16u8, a), v_msa_fill_m64(v16u8, b)));
 }
 
 #define _m_pminub(a, b) _mm_min_pu8(a, b)
@@ -2279,10 +4361,8 @@ FORCE_INLINE __m128i _mm_max_epi16(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_max_pi16(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.msa_v8i16 = __builtin_msa_max_s_h(va.msa_v8i16, vb.msa_v8i16);
-	return va.m64[0];
+	return v_msa_copy_m64(__builtin_msa_max_s_h(
+		v_msa_fill_m64(v8i16, a), v_msa_fill_m64(v8i16, b)));
 }
 
 #define _m_pmaxsw(a, b) _mm_max_pi16(a, b)
@@ -2295,10 +4375,8 @@ FORCE_INLINE __m128i _mm_min_epi16(__m128i a, __m128i b)
 
 FORCE_INLINE __m64 _mm_min_pi16(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.msa_v8i16 = __builtin_msa_min_s_h(va.msa_v8i16, vb.msa_v8i16);
-	return va.m64[0];
+	return v_msa_copy_m64(__builtin_msa_min_s_h(
+		v_msa_fill_m64(v8i16, a), v_msa_fill_m64(v8i16, b)));
 }
 
 #define _m_pminsw(a, b) _mm_min_pi16(a, b)
@@ -2618,46 +4696,298 @@ FORCE_INLINE __m128i _mm_cmpeq_epi64(__m128i a, __m128i b)
 		vreinterpret_v2i64(a), vreinterpret_v2i64(b)));
 }
 
-FORCE_INLINE __m128i _mm_cmplt_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m128i _mm_cmplt_epi8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_b(
+		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+}
+
+FORCE_INLINE __m128i _mm_cmpgt_epi8(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_b(
+		vreinterpret_v16i8(b), vreinterpret_v16i8(a)));
+}
+
+FORCE_INLINE __m128i _mm_cmplt_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_h(
+		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+}
+
+FORCE_INLINE __m128i _mm_cmpgt_epi16(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_h(
+		vreinterpret_v8i16(b), vreinterpret_v8i16(a)));
+}
+
+FORCE_INLINE __m128i _mm_cmplt_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_w(
+		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+}
+
+FORCE_INLINE __m128i _mm_cmpgt_epi32(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_w(
+		vreinterpret_v4i32(b), vreinterpret_v4i32(a)));
+}
+
+FORCE_INLINE __m128i _mm_cmpgt_epi64(__m128i a, __m128i b)
+{
+	return vreinterpret_m128i(__builtin_msa_clt_s_d(
+		vreinterpret_v2i64(b), vreinterpret_v2i64(a)));
+}
+
+/* Ref: nmmintrin.h
+ * Packed string compares.  imm8 is decoded in plain C; with a constant
+ * imm8 the switches fold away and only the selected compare survives.
+ * The 16x16 (8x8) comparison matrix is built one row at a time: row i
+ * compares every element of b against a splat of a[i], so the equal-any
+ * and ranges loops only run for the valid elements of a.
+ */
+#define _SIDD_UBYTE_OPS 0x00
+#define _SIDD_UWORD_OPS 0x01
+#define _SIDD_SBYTE_OPS 0x02
+#define _SIDD_SWORD_OPS 0x03
+
+#define _SIDD_CMP_EQUAL_ANY 0x00
+#define _SIDD_CMP_RANGES 0x04
+#define _SIDD_CMP_EQUAL_EACH 0x08
+#define _SIDD_CMP_EQUAL_ORDERED 0x0c
+
+#define _SIDD_POSITIVE_POLARITY 0x00
+#define _SIDD_NEGATIVE_POLARITY 0x10
+#define _SIDD_MASKED_POSITIVE_POLARITY 0x20
+#define _SIDD_MASKED_NEGATIVE_POLARITY 0x30
+
+#define _SIDD_LEAST_SIGNIFICANT 0x00
+#define _SIDD_MOST_SIGNIFICANT 0x40
+
+#define _SIDD_BIT_MASK 0x00
+#define _SIDD_UNIT_MASK 0x40
+
+#define v_msa_str_n(imm8) ((imm8) & _SIDD_UWORD_OPS ? 8 : 16)
+
+/* lo <= x <= hi; the only mode where signedness matters */
+#define v_msa_cmpstr_range(sfx, vt, uvt, lo, x, hi, imm8)               \
+	((imm8) & _SIDD_SBYTE_OPS ?                                     \
+	 __builtin_msa_cle_s_##sfx(lo, x) &                             \
+		 __builtin_msa_cle_s_##sfx(x, hi) :                     \
+	 __builtin_msa_cle_u_##sfx((uvt)(lo), (uvt)(x)) &               \
+		 __builtin_msa_cle_u_##sfx((uvt)(x), (uvt)(hi)))
+
+/* Unit mask of the (pre-polarity) result for one element size. */
+#define v_msa_cmpstr_body(sfx, vt, uvt, size, iota, a, la, b, lb, imm8) \
+	vt va = __builtin_msa_clt_s_##sfx(iota, __builtin_msa_fill_##sfx(la)); \
+	vt vb = __builtin_msa_clt_s_##sfx(iota, __builtin_msa_fill_##sfx(lb)); \
+	vt ones = __builtin_msa_ldi_##sfx(-1);                           \
+	vt r = __builtin_msa_ldi_##sfx(0);                               \
+	int i;                                                           \
+	switch ((imm8) & _SIDD_CMP_EQUAL_ORDERED) {                      \
+	case _SIDD_CMP_EQUAL_ANY:                                        \
+		for (i = 0; i < (la); i++)                               \
+			r |= __builtin_msa_ceq_##sfx(b,                  \
+				__builtin_msa_splat_##sfx(a, i));        \
+		r &= vb;                                                 \
+		break;                                                   \
+	case _SIDD_CMP_RANGES:                                           \
+		for (i = 0; i + 1 < (la); i += 2)                        \
+			r |= v_msa_cmpstr_range(sfx, vt, uvt,            \
+				__builtin_msa_splat_##sfx(a, i), b,      \
+				__builtin_msa_splat_##sfx(a, i + 1), imm8); \
+		r &= vb;                                                 \
+		break;                                                   \
+	case _SIDD_CMP_EQUAL_EACH:                                       \
+		r = (__builtin_msa_ceq_##sfx(a, b) & va & vb) | ~(va | vb); \
+		break;                                                   \
+	default:                                                         \
+		/* row i is shifted down by i elements; lanes that run   \
+		 * off the end of b are shifted in as matches */         \
+		r = ones;                                                \
+		for (i = 0; i < (la); i++)                               \
+			r &= (vt)__builtin_msa_sld_b((v16i8)ones,        \
+				(v16i8)(__builtin_msa_ceq_##sfx(b,       \
+				__builtin_msa_splat_##sfx(a, i)) & vb),  \
+				i * (size));                             \
+		break;                                                   \
+	}                                                                \
+	if (((imm8) & _SIDD_MASKED_NEGATIVE_POLARITY) ==                 \
+	    _SIDD_MASKED_NEGATIVE_POLARITY)                              \
+		r ^= vb;                                                 \
+	else if ((imm8) & _SIDD_NEGATIVE_POLARITY)                       \
+		r = ~r;
+
+FORCE_INLINE v16i8 v_msa_cmpstr_b(v16i8 a, int la, v16i8 b, int lb,
+				  const int imm8)
+{
+	v16i8 iota = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+	v_msa_cmpstr_body(b, v16i8, v16u8, 1, iota, a, la, b, lb, imm8)
+	return r;
+}
+
+FORCE_INLINE v16i8 v_msa_cmpstr_h(v8i16 a, int la, v8i16 b, int lb,
+				  const int imm8)
+{
+	v8i16 iota = {0, 1, 2, 3, 4, 5, 6, 7};
+	v_msa_cmpstr_body(h, v8i16, v8u16, 2, iota, a, la, b, lb, imm8)
+	return vreinterpret_v16i8(r);
+}
+
+FORCE_INLINE v16i8 v_msa_cmpstr(__m128i a, int la, __m128i b, int lb,
+				const int imm8)
+{
+	if (imm8 & _SIDD_UWORD_OPS)
+		return v_msa_cmpstr_h(vreinterpret_v8i16(a), la,
+				      vreinterpret_v8i16(b), lb, imm8);
+	return v_msa_cmpstr_b(vreinterpret_v16i8(a), la,
+			      vreinterpret_v16i8(b), lb, imm8);
+}
+
+/* One bit per element, as IntRes2 */
+FORCE_INLINE int v_msa_cmpstr_bits(v16i8 r, const int imm8)
+{
+	if (imm8 & _SIDD_UWORD_OPS)
+		return _mm_movemask_epi8(vreinterpret_m128i(__builtin_msa_pckev_b(
+			__builtin_msa_ldi_b(0), r)));
+	return _mm_movemask_epi8(vreinterpret_m128i(r));
+}
+
+/* Implicit length: index of the first zero element */
+FORCE_INLINE int v_msa_str_ilen(__m128i a, const int imm8)
+{
+	int m;
+
+	if (imm8 & _SIDD_UWORD_OPS) {
+		m = _mm_movemask_epi8(vreinterpret_m128i(
+			__builtin_msa_ceqi_h(vreinterpret_v8i16(a), 0)));
+		return m ? __builtin_ctz(m) >> 1 : 8;
+	}
+	m = _mm_movemask_epi8(vreinterpret_m128i(
+		__builtin_msa_ceqi_b(vreinterpret_v16i8(a), 0)));
+	return m ? __builtin_ctz(m) : 16;
+}
+
+/* Explicit length: |l| saturated to the element count */
+FORCE_INLINE int v_msa_str_elen(int l, const int imm8)
+{
+	unsigned int u = l < 0 ? 0u - (unsigned int)l : (unsigned int)l;
+	return u > (unsigned int)v_msa_str_n(imm8) ? v_msa_str_n(imm8) : (int)u;
+}
+
+FORCE_INLINE int v_msa_cmpstr_index(int bits, const int imm8)
+{
+	if (!bits)
+		return v_msa_str_n(imm8);
+	if (imm8 & _SIDD_MOST_SIGNIFICANT)
+		return 31 - __builtin_clz(bits);
+	return __builtin_ctz(bits);
+}
+
+FORCE_INLINE __m128i v_msa_cmpstr_mask(v16i8 r, const int imm8)
+{
+	if (imm8 & _SIDD_UNIT_MASK)
+		return vreinterpret_m128i(r);
+	return vreinterpret_m128i(__builtin_msa_insert_w(
+		v_msa_setzero(v4i32), 0, v_msa_cmpstr_bits(r, imm8)));
+}
+
+FORCE_INLINE int _mm_cmpestri(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	return v_msa_cmpstr_index(v_msa_cmpstr_bits(v_msa_cmpstr(a,
+		v_msa_str_elen(la, imm8), b, v_msa_str_elen(lb, imm8), imm8),
+		imm8), imm8);
+}
+
+FORCE_INLINE __m128i _mm_cmpestrm(__m128i a, int la, __m128i b, int lb,
+				  const int imm8)
+{
+	return v_msa_cmpstr_mask(v_msa_cmpstr(a, v_msa_str_elen(la, imm8),
+		b, v_msa_str_elen(lb, imm8), imm8), imm8);
+}
+
+FORCE_INLINE int _mm_cmpestra(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	lb = v_msa_str_elen(lb, imm8);
+	return lb >= v_msa_str_n(imm8) && !v_msa_cmpstr_bits(v_msa_cmpstr(a,
+		v_msa_str_elen(la, imm8), b, lb, imm8), imm8);
+}
+
+FORCE_INLINE int _mm_cmpestrc(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	return v_msa_cmpstr_bits(v_msa_cmpstr(a, v_msa_str_elen(la, imm8),
+		b, v_msa_str_elen(lb, imm8), imm8), imm8) != 0;
+}
+
+FORCE_INLINE int _mm_cmpestro(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	return v_msa_cmpstr_bits(v_msa_cmpstr(a, v_msa_str_elen(la, imm8),
+		b, v_msa_str_elen(lb, imm8), imm8), imm8) & 1;
+}
+
+FORCE_INLINE int _mm_cmpestrs(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	(void)a;
+	(void)b;
+	(void)lb;
+	return v_msa_str_elen(la, imm8) < v_msa_str_n(imm8);
+}
+
+FORCE_INLINE int _mm_cmpestrz(__m128i a, int la, __m128i b, int lb,
+			      const int imm8)
+{
+	(void)a;
+	(void)b;
+	(void)la;
+	return v_msa_str_elen(lb, imm8) < v_msa_str_n(imm8);
+}
+
+FORCE_INLINE int _mm_cmpistri(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_b(
-		vreinterpret_v16i8(a), vreinterpret_v16i8(b)));
+	return v_msa_cmpstr_index(v_msa_cmpstr_bits(v_msa_cmpstr(a,
+		v_msa_str_ilen(a, imm8), b, v_msa_str_ilen(b, imm8), imm8),
+		imm8), imm8);
 }
 
-FORCE_INLINE __m128i _mm_cmpgt_epi8(__m128i a, __m128i b)
+FORCE_INLINE __m128i _mm_cmpistrm(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_b(
-		vreinterpret_v16i8(b), vreinterpret_v16i8(a)));
+	return v_msa_cmpstr_mask(v_msa_cmpstr(a, v_msa_str_ilen(a, imm8),
+		b, v_msa_str_ilen(b, imm8), imm8), imm8);
 }
 
-FORCE_INLINE __m128i _mm_cmplt_epi16(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cmpistra(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_h(
-		vreinterpret_v8i16(a), vreinterpret_v8i16(b)));
+	int lb = v_msa_str_ilen(b, imm8);
+	return lb >= v_msa_str_n(imm8) && !v_msa_cmpstr_bits(v_msa_cmpstr(a,
+		v_msa_str_ilen(a, imm8), b, lb, imm8), imm8);
 }
 
-FORCE_INLINE __m128i _mm_cmpgt_epi16(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cmpistrc(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_h(
-		vreinterpret_v8i16(b), vreinterpret_v8i16(a)));
+	return v_msa_cmpstr_bits(v_msa_cmpstr(a, v_msa_str_ilen(a, imm8),
+		b, v_msa_str_ilen(b, imm8), imm8), imm8) != 0;
 }
 
-FORCE_INLINE __m128i _mm_cmplt_epi32(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cmpistro(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_w(
-		vreinterpret_v4i32(a), vreinterpret_v4i32(b)));
+	return v_msa_cmpstr_bits(v_msa_cmpstr(a, v_msa_str_ilen(a, imm8),
+		b, v_msa_str_ilen(b, imm8), imm8), imm8) & 1;
 }
 
-FORCE_INLINE __m128i _mm_cmpgt_epi32(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cmpistrs(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_w(
-		vreinterpret_v4i32(b), vreinterpret_v4i32(a)));
+	(void)b;
+	return v_msa_str_ilen(a, imm8) < v_msa_str_n(imm8);
 }
 
-FORCE_INLINE __m128i _mm_cmpgt_epi64(__m128i a, __m128i b)
+FORCE_INLINE int _mm_cmpistrz(__m128i a, __m128i b, const int imm8)
 {
-	return vreinterpret_m128i(__builtin_msa_clt_s_d(
-		vreinterpret_v2i64(b), vreinterpret_v2i64(a)));
+	(void)a;
+	return v_msa_str_ilen(b, imm8) < v_msa_str_n(imm8);
 }
 
 FORCE_INLINE __m128 _mm_cmpord_ps(__m128 a, __m128 b)
@@ -2704,123 +5034,317 @@ FORCE_INLINE __m128d _mm_cmpunord_sd(__m128d a, __m128d b)
 	return _mm_move_sd(a, _mm_cmpunord_pd(a, b));
 }
 
+/*
+ * Scalar compares on the FPU register aliasing lane 0. `pred` is the R6
+ * cmp.cond name: lt/le/eq are quiet (ucomi), slt/sle/seq signal on any
+ * NaN (comi). Pre-R6 cores use the matching c.cond.fmt and read $fcc0.
+ */
+#if defined(__mips_hard_float) && __mips_isa_rev >= 6
+#define v_fpu_cmp(pred, fmt, x, y) __extension__({                   \
+	int _r;                                                          \
+	__typeof__(x) _t;                                                \
+	__asm__("cmp." #pred "." #fmt " %1, %2, %3\n\t"                  \
+		"mfc1 %0, %1\n\t"                                          \
+		"andi %0, %0, 1"                                         \
+		: "=r"(_r), "=&f"(_t) : "f"(x), "f"(y));                 \
+	_r;})
+#elif defined(__mips_hard_float)
+#define v_fpu_c_lt  "olt"
+#define v_fpu_c_le  "ole"
+#define v_fpu_c_eq  "eq"
+#define v_fpu_c_slt "lt"
+#define v_fpu_c_sle "le"
+#define v_fpu_c_seq "seq"
+#define v_fpu_cmp(pred, fmt, x, y) __extension__({                   \
+	int _r;                                                          \
+	__asm__("c." v_fpu_c_##pred "." #fmt " %1, %2\n\t"               \
+		"li %0, 1\n\t"                                             \
+		"movf %0, $0, $fcc0"                                     \
+		: "=&r"(_r) : "f"(x), "f"(y) : "$fcc0");                 \
+	_r;})
+#else
+#define v_fpu_op_lt(x, y)  __builtin_isless(x, y)
+#define v_fpu_op_le(x, y)  __builtin_islessequal(x, y)
+#define v_fpu_op_eq(x, y)  (!__builtin_islessgreater(x, y) && \
+                            !__builtin_isunordered(x, y))
+#define v_fpu_op_slt(x, y) ((x) < (y))
+#define v_fpu_op_sle(x, y) ((x) <= (y))
+#define v_fpu_op_seq(x, y) ((x) == (y))
+#define v_fpu_cmp(pred, fmt, x, y) (v_fpu_op_##pred(x, y) ? 1 : 0)
+#endif
+
 FORCE_INLINE int _mm_comilt_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) <
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return v_fpu_cmp(slt, s, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comilt_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) <
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return v_fpu_cmp(slt, d, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comigt_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) >
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return v_fpu_cmp(slt, s, b[0], a[0]);
 }
 
 FORCE_INLINE int _mm_comigt_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) >
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return v_fpu_cmp(slt, d, b[0], a[0]);
 }
 
 FORCE_INLINE int _mm_comile_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) <=
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return v_fpu_cmp(sle, s, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comile_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) <=
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return v_fpu_cmp(sle, d, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comige_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) >=
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return v_fpu_cmp(sle, s, b[0], a[0]);
 }
 
 FORCE_INLINE int _mm_comige_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) >=
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return v_fpu_cmp(sle, d, b[0], a[0]);
 }
 
-
 FORCE_INLINE int _mm_comieq_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) ==
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return v_fpu_cmp(seq, s, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comieq_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) ==
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return v_fpu_cmp(seq, d, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comineq_ss(__m128 a, __m128 b)
 {
-	return vreinterpret_nth_f32_m128(a, 0) !=
-		vreinterpret_nth_f32_m128(b, 0) ? 1 : 0;
+	return !v_fpu_cmp(seq, s, a[0], b[0]);
 }
 
 FORCE_INLINE int _mm_comineq_sd(__m128d a, __m128d b)
 {
-	return vreinterpret_nth_f64_m128d(a, 0) !=
-		vreinterpret_nth_f64_m128d(b, 0) ? 1 : 0;
+	return !v_fpu_cmp(seq, d, a[0], b[0]);
 }
 
-/* 
- * according to the documentation, these intrinsics behave the same as the
- * non-'u' versions.  We'll just alias them here.
+FORCE_INLINE int _mm_ucomilt_ss(__m128 a, __m128 b)
+{
+	return v_fpu_cmp(lt, s, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomilt_sd(__m128d a, __m128d b)
+{
+	return v_fpu_cmp(lt, d, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomigt_ss(__m128 a, __m128 b)
+{
+	return v_fpu_cmp(lt, s, b[0], a[0]);
+}
+
+FORCE_INLINE int _mm_ucomigt_sd(__m128d a, __m128d b)
+{
+	return v_fpu_cmp(lt, d, b[0], a[0]);
+}
+
+FORCE_INLINE int _mm_ucomile_ss(__m128 a, __m128 b)
+{
+	return v_fpu_cmp(le, s, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomile_sd(__m128d a, __m128d b)
+{
+	return v_fpu_cmp(le, d, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomige_ss(__m128 a, __m128 b)
+{
+	return v_fpu_cmp(le, s, b[0], a[0]);
+}
+
+FORCE_INLINE int _mm_ucomige_sd(__m128d a, __m128d b)
+{
+	return v_fpu_cmp(le, d, b[0], a[0]);
+}
+
+FORCE_INLINE int _mm_ucomieq_ss(__m128 a, __m128 b)
+{
+	return v_fpu_cmp(eq, s, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomieq_sd(__m128d a, __m128d b)
+{
+	return v_fpu_cmp(eq, d, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomineq_ss(__m128 a, __m128 b)
+{
+	return !v_fpu_cmp(eq, s, a[0], b[0]);
+}
+
+FORCE_INLINE int _mm_ucomineq_sd(__m128d a, __m128d b)
+{
+	return !v_fpu_cmp(eq, d, a[0], b[0]);
+}
+
+/*
+ * MSACSR/FCSR layout: RM[1:0], flags[6:2], enables[11:7], cause[17:12]
+ * and FS[24].
+ */
+#define SSE2MSA_CSR_RM 0x3
+#define SSE2MSA_CSR_FLAGS 0x7c
+#define SSE2MSA_CSR_ENABLES 0xf80
+#define SSE2MSA_CSR_CAUSE 0x3f000
+#define SSE2MSA_CSR_FS (1 << 24)
+#define SSE2MSA_CSR_MXCSR \
+	(SSE2MSA_CSR_RM | SSE2MSA_CSR_FLAGS | SSE2MSA_CSR_ENABLES | SSE2MSA_CSR_FS)
+
+#if defined(__mips_hard_float)
+#define v_fpu_get_fcsr() __builtin_mips_get_fcsr()
+#define v_fpu_set_fcsr(x) __builtin_mips_set_fcsr(x)
+#else
+#define v_fpu_get_fcsr() 0u
+#define v_fpu_set_fcsr(x) ((void)(x))
+#endif
+
+/* RC and RM agree on nearest and up and swap down and toward zero */
+#define v_msa_swap_round(r) ((r) & 1 ? (r) ^ 2 : (r))
+
+/*
+ * Rounding-mode shadow. Inside SSE2MSA_ROUNDING_SCOPE the RM field is
+ * pinned to sse2msa_rm_shadow, so an intrinsic asking for that mode does
+ * no control-register traffic at all; outside a scope the shadow is -1
+ * and the live RM is read with cfcmsa. Intrinsics taking an explicit mode
+ * put back the RM they found, as the x86 immediate leaves MXCSR alone.
+ */
+SHARED_TLS int sse2msa_rm_shadow = -1;
+
+/* frint reads RM implicitly; keep it between the ctcmsa pair */
+#if defined(__mips)
+#define v_msa_rm_fence(x) __asm__ __volatile__("" : "+f"(x))
+#else
+#define v_msa_rm_fence(x) __asm__ __volatile__("" : "+m"(x))
+#endif
+
+FORCE_INLINE void v_msa_write_rm(int rm)
+{
+	__builtin_msa_ctcmsa(1, (__builtin_msa_cfcmsa(1) &
+		~(SSE2MSA_CSR_RM | SSE2MSA_CSR_CAUSE)) | rm);
+}
+
+FORCE_INLINE int v_msa_current_rm(void)
+{
+	return sse2msa_rm_shadow >= 0 ?
+		sse2msa_rm_shadow : __builtin_msa_cfcmsa(1) & SSE2MSA_CSR_RM;
+}
+
+/* Switch to `rm`; returns the mode v_msa_rm_leave() must restore */
+FORCE_INLINE int v_msa_rm_enter(int rm)
+{
+	int cur = v_msa_current_rm();
+	if (cur != rm)
+		v_msa_write_rm(rm);
+	return cur;
+}
+
+FORCE_INLINE void v_msa_rm_leave(int rm, int prev)
+{
+	if (prev != rm)
+		v_msa_write_rm(prev);
+}
+
+#define v_msa_frint_rm(type, sfx, x, rm)                             \
+__extension__({                                                      \
+	type _x = (x);                                               \
+	int _prev = v_msa_rm_enter(rm);                              \
+	v_msa_rm_fence(_x);                                          \
+	_x = (type)__builtin_msa_frint_##sfx(_x);                    \
+	v_msa_rm_fence(_x);                                          \
+	v_msa_rm_leave(rm, _prev);                                   \
+	_x;                                                          \
+})
+
+/* The scalar FPU keeps its own RM in FCSR */
+FORCE_INLINE void v_fpu_write_rm(int rm)
+{
+#if defined(__mips_hard_float)
+	unsigned int f = v_fpu_get_fcsr();
+	if ((int)(f & SSE2MSA_CSR_RM) != rm)
+		v_fpu_set_fcsr((f & ~(SSE2MSA_CSR_RM | SSE2MSA_CSR_CAUSE)) | rm);
+#else
+	(void)rm;
+#endif
+}
+
+typedef struct sse2msa_rounding_state {
+	int shadow;
+	int rm;
+} sse2msa_rounding_state;
+
+/* Pin the rounding mode (_MM_ROUND_*) until sse2msa_rounding_leave() */
+FORCE_INLINE sse2msa_rounding_state sse2msa_rounding_enter(unsigned int mode)
+{
+	int rm = v_msa_swap_round(mode >> 13 & 3);
+	sse2msa_rounding_state st = {sse2msa_rm_shadow, v_msa_current_rm()};
+	v_msa_rm_enter(rm);
+	v_fpu_write_rm(rm);
+	sse2msa_rm_shadow = rm;
+	return st;
+}
+
+FORCE_INLINE void sse2msa_rounding_leave(sse2msa_rounding_state st)
+{
+	v_msa_rm_leave(sse2msa_rm_shadow, st.rm);
+	v_fpu_write_rm(st.rm);
+	sse2msa_rm_shadow = st.shadow;
+}
+
+/*
+ * SSE2MSA_ROUNDING_SCOPE_BEGIN(_MM_ROUND_DOWN);
+ *     ... rounding-sensitive intrinsics ...
+ * SSE2MSA_ROUNDING_SCOPE_END();
+ *
+ * The pair opens and closes a block; leaving it by return, break or goto
+ * skips the restore. C++ code can use SSE2MSA_ROUNDING_SCOPE(mode), which
+ * restores on every exit path.
  */
-#define _mm_ucomilt_ss _mm_comilt_ss
-#define _mm_ucomile_ss _mm_comile_ss
-#define _mm_ucomigt_ss _mm_comigt_ss
-#define _mm_ucomige_ss _mm_comige_ss
-#define _mm_ucomieq_ss _mm_comieq_ss
-#define _mm_ucomineq_ss _mm_comineq_ss
-#define _mm_ucomieq_sd _mm_comieq_sd
-#define _mm_ucomige_sd _mm_comige_sd
-#define _mm_ucomigt_sd _mm_comigt_sd
-#define _mm_ucomile_sd _mm_comile_sd
-#define _mm_ucomilt_sd _mm_comilt_sd
-#define _mm_ucomineq_sd _mm_comineq_sd
+#define SSE2MSA_ROUNDING_SCOPE_BEGIN(mode) \
+	{ sse2msa_rounding_state _sse2msa_rs = sse2msa_rounding_enter(mode)
+#define SSE2MSA_ROUNDING_SCOPE_END() \
+	sse2msa_rounding_leave(_sse2msa_rs); }
+
+#if defined(__cplusplus)
+class sse2msa_rounding_scope {
+public:
+	explicit sse2msa_rounding_scope(unsigned int mode)
+		: st(sse2msa_rounding_enter(mode)) {}
+	~sse2msa_rounding_scope() { sse2msa_rounding_leave(st); }
+private:
+	sse2msa_rounding_scope(const sse2msa_rounding_scope &);
+	sse2msa_rounding_scope &operator=(const sse2msa_rounding_scope &);
+	sse2msa_rounding_state st;
+};
+
+#define v_msa_scope_name2(n) _sse2msa_rounding_scope_##n
+#define v_msa_scope_name(n) v_msa_scope_name2(n)
+#define SSE2MSA_ROUNDING_SCOPE(mode) \
+	sse2msa_rounding_scope v_msa_scope_name(__LINE__)(mode)
+#endif
 
 FORCE_INLINE __m128 _mm_round_ps(__m128 a, int rounding)
 {
-	switch (rounding) {
-	case (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x0 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x3);
-		return vreinterpret_m128(
-			__builtin_msa_frint_w(vreinterpret_v4f32(a)));
-	case (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x1 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x2);
-		return vreinterpret_m128(
-			__builtin_msa_frint_w(vreinterpret_v4f32(a)));
-	case (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-		return vreinterpret_m128(
-			__builtin_msa_frint_w(vreinterpret_v4f32(a)));
-	case (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-			(__builtin_msa_cfcmsa(1) | 0x3));
-		return vreinterpret_m128(
-			__builtin_msa_frint_w(vreinterpret_v4f32(a)));
-	default:
+	int mode = rounding & ~_MM_FROUND_NO_EXC;
+	if (mode & _MM_FROUND_CUR_DIRECTION)
 		return vreinterpret_m128(
 			__builtin_msa_frint_w(vreinterpret_v4f32(a)));
-	}
+	return vreinterpret_m128(v_msa_frint_rm(v4f32, w,
+		vreinterpret_v4f32(a), v_msa_swap_round(mode & 3)));
 }
 
 FORCE_INLINE __m128 _mm_round_ss(__m128 a, __m128 b, int rounding)
@@ -2830,31 +5354,12 @@ FORCE_INLINE __m128 _mm_round_ss(__m128 a, __m128 b, int rounding)
 
 FORCE_INLINE __m128d _mm_round_pd(__m128d a, int rounding)
 {
-	switch (rounding) {
-	case (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x0 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x3);
-		return vreinterpret_m128d(
-			__builtin_msa_frint_d(vreinterpret_v2f64(a)));
-	case (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x1 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x2);
-		return vreinterpret_m128d(
-			__builtin_msa_frint_d(vreinterpret_v2f64(a)));
-	case (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-		return vreinterpret_m128d(
-			__builtin_msa_frint_d(vreinterpret_v2f64(a)));
-	case (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC):
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-			(__builtin_msa_cfcmsa(1) | 0x3));
-		return vreinterpret_m128d(
-			__builtin_msa_frint_d(vreinterpret_v2f64(a)));
-	default:
+	int mode = rounding & ~_MM_FROUND_NO_EXC;
+	if (mode & _MM_FROUND_CUR_DIRECTION)
 		return vreinterpret_m128d(
 			__builtin_msa_frint_d(vreinterpret_v2f64(a)));
-	}
+	return vreinterpret_m128d(v_msa_frint_rm(v2f64, d,
+		vreinterpret_v2f64(a), v_msa_swap_round(mode & 3)));
 }
 
 FORCE_INLINE __m128d _mm_round_sd(__m128d a, __m128d b, int rounding)
@@ -2864,38 +5369,120 @@ FORCE_INLINE __m128d _mm_round_sd(__m128d a, __m128d b, int rounding)
 
 FORCE_INLINE void _MM_SET_ROUNDING_MODE(unsigned int a)
 {
-	switch (a) {
-	case _MM_ROUND_NEAREST:
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x0 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x3);
-		break;
-	case _MM_ROUND_TOWARD_ZERO:
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x1 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x2);
-		break;
-	case _MM_ROUND_UP:
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-			(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-		break;
-	case _MM_ROUND_DOWN:
-		__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-			(__builtin_msa_cfcmsa(1) | 0x3));
-		break;
-	}
+	int rm = v_msa_swap_round(a >> 13 & 3);
+	v_msa_rm_enter(rm);
+	v_fpu_write_rm(rm);
+	if (sse2msa_rm_shadow >= 0)
+		sse2msa_rm_shadow = rm;
 }
 
 FORCE_INLINE unsigned int _MM_GET_ROUNDING_MODE()
 {
-	int m = __builtin_msa_cfcmsa(1) & 0x3; /* MSACSR[1:0] */
-	switch (m) {
-	case 0: return _MM_ROUND_NEAREST;
-	case 1: return _MM_ROUND_TOWARD_ZERO;
-	case 2: return _MM_ROUND_UP;
-	case 3: return _MM_ROUND_DOWN;
-	}
+	return v_msa_swap_round(v_msa_current_rm()) << 13;
+}
+
+/* Ref: xmmintrin.h */
+#define _MM_EXCEPT_INVALID 0x0001
+#define _MM_EXCEPT_DENORM 0x0002
+#define _MM_EXCEPT_DIV_ZERO 0x0004
+#define _MM_EXCEPT_OVERFLOW 0x0008
+#define _MM_EXCEPT_UNDERFLOW 0x0010
+#define _MM_EXCEPT_INEXACT 0x0020
+#define _MM_EXCEPT_MASK 0x003f
+
+#define _MM_MASK_INVALID 0x0080
+#define _MM_MASK_DENORM 0x0100
+#define _MM_MASK_DIV_ZERO 0x0200
+#define _MM_MASK_OVERFLOW 0x0400
+#define _MM_MASK_UNDERFLOW 0x0800
+#define _MM_MASK_INEXACT 0x1000
+#define _MM_MASK_MASK 0x1f80
+
+#define _MM_ROUND_MASK 0x6000
+
+#define _MM_FLUSH_ZERO_MASK 0x8000
+#define _MM_FLUSH_ZERO_ON 0x8000
+#define _MM_FLUSH_ZERO_OFF 0x0000
+
+#define _MM_DENORMALS_ZERO_MASK 0x0040
+#define _MM_DENORMALS_ZERO_ON 0x0040
+#define _MM_DENORMALS_ZERO_OFF 0x0000
+
+/*
+ * MXCSR is emulated on MSACSR, and on FCSR for the scalar FPU ops. The
+ * rounding encodings swap down and toward-zero, enables are inverted
+ * masks, and FTZ and DAZ both map onto FS. The denormal flag and
+ * mask, and which of FTZ/DAZ asked for FS, have no hardware bit and live
+ * in a per-thread shadow shared by all TUs. A control register is only
+ * written when its live value differs, because ctcmsa/ctc1 serialize the
+ * pipeline.
+ */
+SHARED_TLS unsigned int sse2msa_mxcsr_shadow = 0x1f80;
+
+/* MXCSR exception order is V D Z O U I, MSACSR order is I U O Z V */
+FORCE_INLINE unsigned int v_msa_except_from_mxcsr(unsigned int m)
+{
+	return (m >> 5 & 1) | (m >> 3 & 2) | (m >> 1 & 4) |
+		(m << 1 & 8) | (m << 4 & 16);
+}
+
+FORCE_INLINE unsigned int v_msa_except_to_mxcsr(unsigned int c)
+{
+	return (c >> 4 & 1) | (c >> 1 & 4) | (c << 1 & 8) |
+		(c << 3 & 16) | (c << 5 & 32);
+}
+
+FORCE_INLINE unsigned int _mm_getcsr(void)
+{
+	unsigned int c = __builtin_msa_cfcmsa(1);
+	unsigned int f = v_fpu_get_fcsr();
+	unsigned int sh = sse2msa_mxcsr_shadow;
+	unsigned int m = v_msa_swap_round(c & SSE2MSA_CSR_RM) << 13;
+	m |= v_msa_except_to_mxcsr(((c | f) & SSE2MSA_CSR_FLAGS) >> 2);
+	m |= v_msa_except_to_mxcsr(~c >> 7 & 0x1f) << 7;
+	m |= sh & (_MM_EXCEPT_DENORM | _MM_MASK_DENORM);
+	if (c & SSE2MSA_CSR_FS)
+		m |= sh & (_MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK) ?
+			sh & (_MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK) :
+			_MM_FLUSH_ZERO_ON;
 	return m;
 }
 
+FORCE_INLINE void _mm_setcsr(unsigned int m)
+{
+	unsigned int c = v_msa_swap_round(m >> 13 & 3);
+	c |= v_msa_except_from_mxcsr(m & 0x3f) << 2;
+	c |= v_msa_except_from_mxcsr(~m >> 7 & 0x3f) << 7;
+	if (m & (_MM_FLUSH_ZERO_MASK | _MM_DENORMALS_ZERO_MASK))
+		c |= SSE2MSA_CSR_FS;
+	sse2msa_mxcsr_shadow = m;
+	if (sse2msa_rm_shadow >= 0)
+		sse2msa_rm_shadow = c & SSE2MSA_CSR_RM;
+
+	unsigned int cur = __builtin_msa_cfcmsa(1);
+	if ((cur & SSE2MSA_CSR_MXCSR) != c)
+		__builtin_msa_ctcmsa(1,
+			(cur & ~(SSE2MSA_CSR_MXCSR | SSE2MSA_CSR_CAUSE)) | c);
+#if defined(__mips_hard_float)
+	cur = v_fpu_get_fcsr();
+	if ((cur & SSE2MSA_CSR_MXCSR) != c)
+		v_fpu_set_fcsr((cur & ~(SSE2MSA_CSR_MXCSR | SSE2MSA_CSR_CAUSE)) | c);
+#endif
+}
+
+#define _MM_GET_EXCEPTION_STATE() (_mm_getcsr() & _MM_EXCEPT_MASK)
+#define _MM_SET_EXCEPTION_STATE(x) \
+	_mm_setcsr((_mm_getcsr() & ~_MM_EXCEPT_MASK) | (x))
+#define _MM_GET_EXCEPTION_MASK() (_mm_getcsr() & _MM_MASK_MASK)
+#define _MM_SET_EXCEPTION_MASK(x) \
+	_mm_setcsr((_mm_getcsr() & ~_MM_MASK_MASK) | (x))
+#define _MM_GET_FLUSH_ZERO_MODE() (_mm_getcsr() & _MM_FLUSH_ZERO_MASK)
+#define _MM_SET_FLUSH_ZERO_MODE(x) \
+	_mm_setcsr((_mm_getcsr() & ~_MM_FLUSH_ZERO_MASK) | (x))
+#define _MM_GET_DENORMALS_ZERO_MODE() (_mm_getcsr() & _MM_DENORMALS_ZERO_MASK)
+#define _MM_SET_DENORMALS_ZERO_MODE(x) \
+	_mm_setcsr((_mm_getcsr() & ~_MM_DENORMALS_ZERO_MASK) | (x))
+
 FORCE_INLINE float _mm_cvtss_f32(__m128 a)
 {
 	return vreinterpret_nth_f32_m128(a, 0);
@@ -2928,26 +5515,21 @@ FORCE_INLINE int64_t _mm_cvtsd_si64(__m128d a)
 
 FORCE_INLINE __m128 _mm_cvt_pi2ps(__m128 a, __m64 b)
 {
-	VREG128 vb = {.m64 = {b, {0}}};
-	vb.msa_v4f32 = __builtin_msa_ffint_s_w(vb.msa_v4i32);
-	VREG128 *v = (VREG128*)&a;
-	v->m64[0] = vb.m64[0];
-	return v->m128;
+	v4f32 f = __builtin_msa_ffint_s_w(v_msa_fill_m64(v4i32, b));
+	return vreinterpret_m128(__builtin_msa_insve_d(
+		vreinterpret_v2i64(a), 0, vreinterpret_v2i64(f)));
 }
 
 FORCE_INLINE __m64 _mm_cvt_ps2pi(__m128 a)
 {
-	VREG128 v = {
-		.msa_v4i32 = __builtin_msa_ftint_s_w(vreinterpret_v4f32(a))
-	};
-	return v.m64[0];
+	return v_msa_copy_m64(
+		__builtin_msa_ftint_s_w(vreinterpret_v4f32(a)));
 }
 
 FORCE_INLINE __m128 _mm_cvt_si2ss(__m128 a, int b)
 {
-	float f = (float)b;
-	return vreinterpret_m128(__builtin_msa_insert_w(
-		vreinterpret_v4i32(a), 0, reinterpret_i32(f)));
+	return _mm_move_ss(a, vreinterpret_m128(
+		__builtin_msa_ffint_s_w(__builtin_msa_fill_w(b))));
 }
 
 FORCE_INLINE int _mm_cvt_ss2si(__m128 a)
@@ -2960,86 +5542,83 @@ FORCE_INLINE int _mm_cvt_ss2si(__m128 a)
 
 #define _mm_cvtsi32_ss(a, b) _mm_cvt_si2ss(a, b)
 
+/*
+ * ffint_s_d then fexdo_w would round twice. Outside +-2^53 the bits below
+ * 2^11 are first folded into a sticky bit (round to odd), which makes the
+ * double exact and leaves fexdo_w the only rounding.
+ */
 FORCE_INLINE __m128 _mm_cvtsi64_ss(__m128 a, int64_t b)
 {
-	float f = (float)b;
-	return vreinterpret_m128(__builtin_msa_insert_w(
-		vreinterpret_v4i32(a), 0, reinterpret_i32(f)));
+	if ((uint64_t)b + (1ULL << 53) >= 1ULL << 54)
+		b = (b & ~(int64_t)0x7ff) | (int64_t)((b & 0x7ff) != 0) << 11;
+	v2f64 d = __builtin_msa_ffint_s_d(__builtin_msa_fill_d(b));
+	return _mm_move_ss(a, vreinterpret_m128(__builtin_msa_fexdo_w(d, d)));
 }
 
 FORCE_INLINE __m128d _mm_cvtsi64_sd(__m128d a, int64_t b)
 {
-	double f = (float)b;
-	return vreinterpret_m128d(__builtin_msa_insert_d(
-		vreinterpret_v2i64(a), 0, reinterpret_i64(f)));
+	return _mm_move_sd(a, vreinterpret_m128d(
+		__builtin_msa_ffint_s_d(__builtin_msa_fill_d(b))));
 }
 
 #define _mm_cvtsi64x_sd(a, b) _mm_cvtsi64_sd(a, b)
 
+/*
+ * Interleaving a vector with itself replicates each element into the
+ * wider lane, an arithmetic/logical shift right then leaves it sign/zero
+ * extended, ready for a single `ffint`.
+ */
 FORCE_INLINE __m128 _mm_cvtpi8_ps(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.f32[3] = (float)v.i8[3];
-	v.f32[2] = (float)v.i8[2];
-	v.f32[1] = (float)v.i8[1];
-	v.f32[0] = (float)v.i8[0];
-	return v.m128;
+	v16i8 v = v_msa_fill_m64(v16i8, a);
+	v8i16 h = vreinterpret_v8i16(__builtin_msa_ilvr_b(v, v));
+	v4i32 w = vreinterpret_v4i32(__builtin_msa_ilvr_h(h, h));
+	return vreinterpret_m128(
+		__builtin_msa_ffint_s_w(__builtin_msa_srai_w(w, 24)));
 }
 
 FORCE_INLINE __m128 _mm_cvtpi16_ps(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.f32[3] = (float)v.i16[3];
-	v.f32[2] = (float)v.i16[2];
-	v.f32[1] = (float)v.i16[1];
-	v.f32[0] = (float)v.i16[0];
-	return v.m128;
+	v8i16 v = v_msa_fill_m64(v8i16, a);
+	v4i32 w = vreinterpret_v4i32(__builtin_msa_ilvr_h(v, v));
+	return vreinterpret_m128(
+		__builtin_msa_ffint_s_w(__builtin_msa_srai_w(w, 16)));
 }
 
 FORCE_INLINE __m128 _mm_cvtpi32_ps(__m128 a, __m64 b)
 {
-	VREG128 vb = {.m64 = {b, {0}}};
-	vb.msa_v4f32 = __builtin_msa_ffint_s_w(vb.msa_v4i32);
-	VREG128 *v = (VREG128*)&a;
-	v->m64[0] = vb.m64[0];
-	return v->m128;
+	return _mm_cvt_pi2ps(a, b);
 }
 
 FORCE_INLINE __m128d _mm_cvtpi32_pd(__m64 a)
 {
-	union {__m64 m64; int32_t i32[2];} u = {.m64 = a};
-	VREG128 v = {.i64 = {u.i32[0], u.i32[1]}};
-	v.msa_v2f64 = __builtin_msa_ffint_s_d(v.msa_v2i64);
-	return v.m128d;
+	v4i32 v = v_msa_fill_m64(v4i32, a);
+	v2i64 d = vreinterpret_v2i64(__builtin_msa_ilvr_w(v, v));
+	return vreinterpret_m128d(
+		__builtin_msa_ffint_s_d(__builtin_msa_srai_d(d, 32)));
 }
 
 FORCE_INLINE __m128 _mm_cvtpi32x2_ps(__m64 a, __m64 b)
 {
-	VREG128 v = {
-		.m64 = {a, b}
-	};
-	v.msa_v4f32 = __builtin_msa_ffint_s_w(v.msa_v4i32);
-	return v.m128;
+	return vreinterpret_m128(
+		__builtin_msa_ffint_s_w(v_msa_pack_m64(v4i32, a, b)));
 }
 
 FORCE_INLINE __m128 _mm_cvtpu8_ps(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.f32[3] = (float)v.u8[3];
-	v.f32[2] = (float)v.u8[2];
-	v.f32[1] = (float)v.u8[1];
-	v.f32[0] = (float)v.u8[0];
-	return v.m128;
+	v16i8 v = v_msa_fill_m64(v16i8, a);
+	v8i16 h = vreinterpret_v8i16(__builtin_msa_ilvr_b(v, v));
+	v4i32 w = vreinterpret_v4i32(__builtin_msa_ilvr_h(h, h));
+	return vreinterpret_m128(__builtin_msa_ffint_u_w(
+		vreinterpret_v4u32(__builtin_msa_srli_w(w, 24))));
 }
 
 FORCE_INLINE __m128 _mm_cvtpu16_ps(__m64 a)
 {
-	VREG128 v = {.m64 = {a, {0}}};
-	v.f32[3] = (float)v.u16[3];
-	v.f32[2] = (float)v.u16[2];
-	v.f32[1] = (float)v.u16[1];
-	v.f32[0] = (float)v.u16[0];
-	return v.m128;
+	v8i16 v = v_msa_fill_m64(v8i16, a);
+	v4i32 w = vreinterpret_v4i32(__builtin_msa_ilvr_h(v, v));
+	return vreinterpret_m128(__builtin_msa_ffint_u_w(
+		vreinterpret_v4u32(__builtin_msa_srli_w(w, 16))));
 }
 
 FORCE_INLINE __m128i _mm_cvttps_epi32(__m128 a)
@@ -3048,31 +5627,38 @@ FORCE_INLINE __m128i _mm_cvttps_epi32(__m128 a)
 		__builtin_msa_ftrunc_s_w(vreinterpret_v4f32(a)));
 }
 
+/*
+ * Narrow the two int64 results of `ftint`/`ftrunc` on `a` to int32 in the
+ * low half of the vector. NaN and values which do not fit in 32 bits give
+ * the SSE "integer indefinite" value 0x80000000.
+ */
+FORCE_INLINE __m128i sse2msa_pack_epi32_pd(v2i64 t, __m128d a)
+{
+	v2i64 s = __builtin_msa_sat_s_d(t, 31);
+	v2i64 bad = ~__builtin_msa_ceq_d(t, s) | __builtin_msa_fcun_d(
+		vreinterpret_v2f64(a), vreinterpret_v2f64(a));
+	s = vreinterpret_v2i64(__builtin_msa_bsel_v(vreinterpret_v16u8(bad),
+		vreinterpret_v16u8(s),
+		vreinterpret_v16u8(__builtin_msa_fill_d(INT32_MIN))));
+	return vreinterpret_m128i(__builtin_msa_pckev_w(
+		v_msa_setzero(v4i32), vreinterpret_v4i32(s)));
+}
+
 FORCE_INLINE __m128i _mm_cvttpd_epi32(__m128d a)
 {
-	double a0 = ((double *)&a)[0];
-	double a1 = ((double *)&a)[1];
-	return _mm_set_epi32(0, 0, (int32_t)a1, (int32_t)a0);
+	return sse2msa_pack_epi32_pd(
+		__builtin_msa_ftrunc_s_d(vreinterpret_v2f64(a)), a);
 }
 
 FORCE_INLINE __m64 _mm_cvttpd_pi32(__m128d a)
 {
-	double a0 = ((double *)&a)[0];
-	double a1 = ((double *)&a)[1];
-	VREG128 v = {
-		.i32 = {
-			(int32_t)a0, (int32_t)a1, 0, 0
-		}
-	};
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_cvttpd_epi32(a));
 }
 
 FORCE_INLINE __m64 _mm_cvtt_ps2pi(__m128 a)
 {
-	VREG128 v = {
-		.msa_v4i32 = __builtin_msa_ftrunc_s_w(vreinterpret_v4f32(a))
-	};
-	return v.m64[0];
+	return v_msa_copy_m64(
+		__builtin_msa_ftrunc_s_w(vreinterpret_v4f32(a)));
 }
 
 #define _mm_cvttps_pi32(a) _mm_cvtt_ps2pi(a)
@@ -3089,8 +5675,8 @@ FORCE_INLINE int _mm_cvtt_ss2si(__m128 a)
 
 FORCE_INLINE int _mm_cvttsd_si32(__m128d a)
 {
-	double ret = *((double*) &a);
-	return (int32_t)ret;
+	return __builtin_msa_copy_s_w(
+		vreinterpret_v4i32(_mm_cvttpd_epi32(a)), 0);
 }
 
 FORCE_INLINE int64_t _mm_cvttsd_si64(__m128d a)
@@ -3264,21 +5850,13 @@ FORCE_INLINE __m128i _mm_cvtps_epi32(__m128 a)
 
 FORCE_INLINE __m128i _mm_cvtpd_epi32(__m128d a)
 {
-	VREG128 v = {
-		.msa_v2i64 = __builtin_msa_ftint_s_d(vreinterpret_v2f64(a))
-	};
-	v.msa_v2i64 = __builtin_msa_slli_d(
-		__builtin_msa_sat_s_d(v.msa_v2i64, 31), 32);
-	v.msa_v4i32 = __builtin_msa_pckod_w(v_msa_setzero(v4i32), v.msa_v4i32);
-	return v.m128i;
+	return sse2msa_pack_epi32_pd(
+		__builtin_msa_ftint_s_d(vreinterpret_v2f64(a)), a);
 }
 
 FORCE_INLINE __m64 _mm_cvtpd_pi32(__m128d a)
 {
-	VREG128 v = {
-		.m128i = _mm_cvtpd_epi32(a)
-	};
-	return v.m64[0];
+	return v_msa_copy_m64(_mm_cvtpd_epi32(a));
 }
 
 FORCE_INLINE int _mm_cvtsd_si32(__m128d a)
@@ -3291,11 +5869,8 @@ FORCE_INLINE int _mm_cvtsd_si32(__m128d a)
 
 FORCE_INLINE __m128 _mm_cvtsd_ss(__m128 a, __m128d b)
 {
-	VREG128 v = {
-		.msa_v4f32 = __builtin_msa_fexdo_w(
-			vreinterpret_v2f64(b), vreinterpret_v2f64(b))
-	};
-	return _mm_move_ss(a, v.m128);
+	return _mm_move_ss(a, vreinterpret_m128(__builtin_msa_fexdo_w(
+		vreinterpret_v2f64(b), vreinterpret_v2f64(b))));
 }
 
 FORCE_INLINE __m64 _mm_cvtps_pi16(__m128 a)
@@ -3306,7 +5881,7 @@ FORCE_INLINE __m64 _mm_cvtps_pi16(__m128 a)
 	v.msa_v4i32 = __builtin_msa_slli_w(
 		__builtin_msa_sat_s_w(v.msa_v4i32, 15), 16);
 	v.msa_v8i16 = __builtin_msa_pckod_h(v.msa_v8i16, v.msa_v8i16);
-	return v.m64[0];
+	return v_msa_copy_m64(v.m128i);
 }
 
 FORCE_INLINE __m64 _mm_cvtps_pi8(__m128 a)
@@ -3319,7 +5894,7 @@ FORCE_INLINE __m64 _mm_cvtps_pi8(__m128 a)
 	v.msa_v8i16 = __builtin_msa_pckod_h(
 		v_msa_setzero(v8i16), v.msa_v8i16);
 	v.msa_v16i8 = __builtin_msa_pckod_b(v.msa_v16i8, v.msa_v16i8);
-	return v.m64[0];
+	return v_msa_copy_m64(v.m128i);
 }
 
 FORCE_INLINE int _mm_cvtsi128_si32(__m128i a)
@@ -3342,9 +5917,8 @@ FORCE_INLINE __m128i _mm_cvtsi32_si128(int a)
 
 FORCE_INLINE __m128d _mm_cvtsi32_sd(__m128d a, int b)
 {
-	VREG128 v = {.m128d = a};
-	v.f64[0] = (double)b;
-	return v.m128d;
+	a[0] = (double)b;
+	return a;
 }
 
 FORCE_INLINE __m128i _mm_cvtsi64_si128(int64_t a)
@@ -3421,66 +5995,46 @@ FORCE_INLINE __m128d _mm_cvtss_sd(__m128d a, __m128 b)
 
 FORCE_INLINE __m128 _mm_ceil_ps(__m128 a)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-		(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-	return vreinterpret_m128(
-		__builtin_msa_frint_w(vreinterpret_v4f32(a)));
+	return vreinterpret_m128(v_msa_frint_rm(v4f32, w,
+		vreinterpret_v4f32(a), 2));
 }
 
 FORCE_INLINE __m128d _mm_ceil_pd(__m128d a)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-		(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-	return vreinterpret_m128d(
-		__builtin_msa_frint_d(vreinterpret_v2f64(a)));
+	return vreinterpret_m128d(v_msa_frint_rm(v2f64, d,
+		vreinterpret_v2f64(a), 2));
 }
 
 FORCE_INLINE __m128 _mm_ceil_ss(__m128 a, __m128 b)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-		(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-	return _mm_move_ss(a, vreinterpret_m128(
-		__builtin_msa_frint_w(vreinterpret_v4f32(b))));
+	return _mm_move_ss(a, _mm_ceil_ps(b));
 }
 
 FORCE_INLINE __m128d _mm_ceil_sd(__m128d a, __m128d b)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x2 */
-		(__builtin_msa_cfcmsa(1) | 0x3) ^ 0x1);
-	return _mm_move_sd(a, vreinterpret_m128d(
-		__builtin_msa_frint_d(vreinterpret_v2f64(b))));
+	return _mm_move_sd(a, _mm_ceil_pd(b));
 }
 
 FORCE_INLINE __m128 _mm_floor_ps(__m128 a)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-		(__builtin_msa_cfcmsa(1) | 0x3));
-	return vreinterpret_m128(
-		__builtin_msa_frint_w(vreinterpret_v4f32(a)));
+	return vreinterpret_m128(v_msa_frint_rm(v4f32, w,
+		vreinterpret_v4f32(a), 3));
 }
 
 FORCE_INLINE __m128d _mm_floor_pd(__m128d a)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-		(__builtin_msa_cfcmsa(1) | 0x3));
-	return vreinterpret_m128d(
-		__builtin_msa_frint_d(vreinterpret_v2f64(a)));
+	return vreinterpret_m128d(v_msa_frint_rm(v2f64, d,
+		vreinterpret_v2f64(a), 3));
 }
 
 FORCE_INLINE __m128 _mm_floor_ss(__m128 a, __m128 b)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-		(__builtin_msa_cfcmsa(1) | 0x3));
-	return _mm_move_ss(a, vreinterpret_m128(
-		__builtin_msa_frint_w(vreinterpret_v4f32(b))));
+	return _mm_move_ss(a, _mm_floor_ps(b));
 }
 
 FORCE_INLINE __m128d _mm_floor_sd(__m128d a, __m128d b)
 {
-	__builtin_msa_ctcmsa(1,   /* MSACSR[1:0] = 0x3 */
-		(__builtin_msa_cfcmsa(1) | 0x3));
-	return _mm_move_sd(a, vreinterpret_m128d(
-		__builtin_msa_frint_d(vreinterpret_v2f64(b))));
+	return _mm_move_sd(a, _mm_floor_pd(b));
 }
 
 FORCE_INLINE __m128i _mm_sra_epi16(__m128i a, __m128i count)
@@ -3497,44 +6051,63 @@ FORCE_INLINE __m128i _mm_sra_epi32(__m128i a, __m128i count)
 	return _mm_srai_epi32(a, ci32);
 }
 
+/*
+ * Saturate each lane to the narrow type, then `pckev` keeps the low half
+ * of every lane: `a` in the low 64 bits, `b` in the high 64 bits.
+ */
 FORCE_INLINE __m128i _mm_packs_epi16(__m128i a, __m128i b)
 {
-	v16i8 mask = {
-		0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 32};
-	return vreinterpret_m128i(__builtin_msa_vshf_b(mask,
+	return vreinterpret_m128i(__builtin_msa_pckev_b(
 		vreinterpret_v16i8(__builtin_msa_sat_s_h(vreinterpret_v8i16(b), 7)),
 		vreinterpret_v16i8(__builtin_msa_sat_s_h(vreinterpret_v8i16(a), 7))));
 }
 
 FORCE_INLINE __m128i _mm_packus_epi16(__m128i a, __m128i b)
 {
-	v16i8 mask = {
-		0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 32};
 	v8i16 u = __builtin_msa_maxi_s_h(vreinterpret_v8i16(a), 0);
 	v8i16 v = __builtin_msa_maxi_s_h(vreinterpret_v8i16(b), 0);
-	return vreinterpret_m128i(__builtin_msa_vshf_b(mask,
+	return vreinterpret_m128i(__builtin_msa_pckev_b(
 		vreinterpret_v16i8(__builtin_msa_sat_u_h(vreinterpret_v8u16(v), 7)),
 		vreinterpret_v16i8(__builtin_msa_sat_u_h(vreinterpret_v8u16(u), 7))));
 }
 
 FORCE_INLINE __m128i _mm_packs_epi32(__m128i a, __m128i b)
 {
-	v8i16 mask = {0, 2, 4, 6, 8, 10, 12, 14};
-	return vreinterpret_m128i(__builtin_msa_vshf_h(mask,
+	return vreinterpret_m128i(__builtin_msa_pckev_h(
 		vreinterpret_v8i16(__builtin_msa_sat_s_w(vreinterpret_v4i32(b), 15)),
 		vreinterpret_v8i16(__builtin_msa_sat_s_w(vreinterpret_v4i32(a), 15))));
 }
 
 FORCE_INLINE __m128i _mm_packus_epi32(__m128i a, __m128i b)
 {
-	v8i16 mask = {0, 2, 4, 6, 8, 10, 12, 14};
 	v4i32 u = __builtin_msa_maxi_s_w(vreinterpret_v4i32(a), 0);
 	v4i32 v = __builtin_msa_maxi_s_w(vreinterpret_v4i32(b), 0);
-	return vreinterpret_m128i(__builtin_msa_vshf_h(mask,
+	return vreinterpret_m128i(__builtin_msa_pckev_h(
 		vreinterpret_v8i16(__builtin_msa_sat_u_w(vreinterpret_v4u32(v), 15)),
 		vreinterpret_v8i16(__builtin_msa_sat_u_w(vreinterpret_v4u32(u), 15))));
 }
 
+/* Pack `a` and `b` as above and store the 16 result bytes to `p` */
+FORCE_INLINE void sse2msa_storeu_packs_epi16(void *p, __m128i a, __m128i b)
+{
+	__builtin_msa_st_b(vreinterpret_v16i8(_mm_packs_epi16(a, b)), p, 0);
+}
+
+FORCE_INLINE void sse2msa_storeu_packus_epi16(void *p, __m128i a, __m128i b)
+{
+	__builtin_msa_st_b(vreinterpret_v16i8(_mm_packus_epi16(a, b)), p, 0);
+}
+
+FORCE_INLINE void sse2msa_storeu_packs_epi32(void *p, __m128i a, __m128i b)
+{
+	__builtin_msa_st_h(vreinterpret_v8i16(_mm_packs_epi32(a, b)), p, 0);
+}
+
+FORCE_INLINE void sse2msa_storeu_packus_epi32(void *p, __m128i a, __m128i b)
+{
+	__builtin_msa_st_h(vreinterpret_v8i16(_mm_packus_epi32(a, b)), p, 0);
+}
+
 FORCE_INLINE __m128i _mm_unpacklo_epi8(__m128i a, __m128i b)
 {
 	return vreinterpret_m128i(
@@ -3645,8 +6218,7 @@ FORCE_INLINE __m128i _mm_minpos_epu16(__m128i a)
 (__builtin_msa_copy_u_h(vreinterpret_v8i16(a), imm8))
 
 #define _mm_extract_pi16(a, imm8) \
-__extension__({VREG128 v = {.m64 = {a, {0}}}; \
-	__builtin_msa_copy_u_h(v.msa_v8i16, imm8);})
+(__builtin_msa_copy_u_h(v_msa_fill_m64(v8i16, a), imm8))
 
 #define _mm_extract_epi32(a, imm8) \
 (__builtin_msa_copy_s_w(vreinterpret_v4i32(a), imm8))
@@ -3666,10 +6238,7 @@ __extension__((__m128i)                                              \
 	({__builtin_msa_insert_h(vreinterpret_v8i16(a), imm8, b);}))
 
 #define _mm_insert_pi16(a, b, imm8) \
-__extension__({                                                \
-  VREG128 v = {.m64 = {a, {0}}};                               \
-  v.msa_v8i16 = __builtin_msa_insert_h(v.msa_v8i16, imm8, b);  \
-  v.m64[0];})
+v_msa_copy_m64(__builtin_msa_insert_h(v_msa_fill_m64(v8i16, a), imm8, b))
 
 #define _mm_insert_epi32(a, b, imm8) \
 __extension__((__m128i)                                              \
@@ -3679,56 +6248,94 @@ __extension__((__m128i)                                              \
 __extension__((__m128i)                                              \
 	({__builtin_msa_insert_d(vreinterpret_v2i64(a), imm8, b);}))
 
+/*
+ * insertps: b[imm8[7:6]] goes to lane imm8[5:4], lanes in imm8[3:0] are
+ * cleared. With a literal imm8 all of this folds: source lane 0 skips the
+ * splati, the zero mask is one and.v with a constant, and a mask clearing
+ * every other lane inserts into a zeroed register instead.
+ */
+#define v_msa_insert_ps_src(imm8) (((imm8) >> 6) & 3)
+#define v_msa_insert_ps_dst(imm8) (((imm8) >> 4) & 3)
+#define v_msa_insert_ps_into_zero(imm8) \
+	((((imm8) & 0xf) | (1 << v_msa_insert_ps_dst(imm8))) == 0xf)
+
+#define _mm_insert_ps(a, b, imm8) \
+__extension__((__m128)({                                               \
+	v4i32 _s = v_msa_insert_ps_src(imm8) ?                         \
+		__builtin_msa_splati_w(vreinterpret_v4i32(b),          \
+			v_msa_insert_ps_src(imm8)) :                   \
+		vreinterpret_v4i32(b);                                 \
+	v4i32 _d = __builtin_msa_insve_w(                              \
+		v_msa_insert_ps_into_zero(imm8) ?                      \
+			v_msa_setzero(v4i32) : vreinterpret_v4i32(a),  \
+		v_msa_insert_ps_dst(imm8), _s);                        \
+	if ((imm8) & (v_msa_insert_ps_into_zero(imm8) ?                \
+		      1 << v_msa_insert_ps_dst(imm8) : 0xf))           \
+		_d &= (v4i32){(imm8) & 1 ? 0 : -1, (imm8) & 2 ? 0 : -1, \
+			      (imm8) & 4 ? 0 : -1, (imm8) & 8 ? 0 : -1}; \
+	_d;                                                            \
+}))
+
 #define _m_pextrw(a, imm) _mm_extract_pi16(a, imm)
 
 #define _m_pinsrw(a, i, imm) _mm_insert_pi16(a, i, imm)
 
+/*
+ * psign without a multiply: pick `-a` where `b < 0`, then clear the lanes
+ * where `b == 0`.
+ */
 FORCE_INLINE __m128i _mm_sign_epi8(__m128i a, __m128i b)
 {
-	v16i8 mask = __builtin_msa_maxi_s_b(vreinterpret_v16i8(b), -1);
-	mask = __builtin_msa_mini_s_b(vreinterpret_v16i8(mask), 1);
-	return vreinterpret_m128i(
-		__builtin_msa_mulv_b(vreinterpret_v16i8(a), mask));
+	v16i8 zero = __builtin_msa_ldi_b(0);
+	v16i8 neg = __builtin_msa_subv_b(zero, vreinterpret_v16i8(a));
+	v16u8 r = __builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_clti_s_b(vreinterpret_v16i8(b), 0)),
+		vreinterpret_v16u8(a), vreinterpret_v16u8(neg));
+	return vreinterpret_m128i(__builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_ceqi_b(vreinterpret_v16i8(b), 0)),
+		r, vreinterpret_v16u8(zero)));
 }
 
 FORCE_INLINE __m128i _mm_sign_epi16(__m128i a, __m128i b)
 {
-	v8i16 mask = __builtin_msa_maxi_s_h(vreinterpret_v8i16(b), -1);
-	mask = __builtin_msa_mini_s_h(vreinterpret_v8i16(mask), 1);
-	return vreinterpret_m128i(
-		__builtin_msa_mulv_h(vreinterpret_v8i16(a), mask));
+	v8i16 zero = __builtin_msa_ldi_h(0);
+	v8i16 neg = __builtin_msa_subv_h(zero, vreinterpret_v8i16(a));
+	v16u8 r = __builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_clti_s_h(vreinterpret_v8i16(b), 0)),
+		vreinterpret_v16u8(a), vreinterpret_v16u8(neg));
+	return vreinterpret_m128i(__builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_ceqi_h(vreinterpret_v8i16(b), 0)),
+		r, vreinterpret_v16u8(zero)));
 }
 
 FORCE_INLINE __m128i _mm_sign_epi32(__m128i a, __m128i b)
 {
-	v4i32 mask = __builtin_msa_maxi_s_w(vreinterpret_v4i32(b), -1);
-	mask = __builtin_msa_mini_s_w(vreinterpret_v4i32(mask), 1);
-	return vreinterpret_m128i(
-		__builtin_msa_mulv_w(vreinterpret_v4i32(a), mask));
+	v4i32 zero = __builtin_msa_ldi_w(0);
+	v4i32 neg = __builtin_msa_subv_w(zero, vreinterpret_v4i32(a));
+	v16u8 r = __builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_clti_s_w(vreinterpret_v4i32(b), 0)),
+		vreinterpret_v16u8(a), vreinterpret_v16u8(neg));
+	return vreinterpret_m128i(__builtin_msa_bsel_v(
+		vreinterpret_v16u8(__builtin_msa_ceqi_w(vreinterpret_v4i32(b), 0)),
+		r, vreinterpret_v16u8(zero)));
 }
 
 FORCE_INLINE __m64 _mm_sign_pi8(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.m128i = _mm_sign_epi8(va.m128i, vb.m128i);
-	return va.m64[0];
+	return v_msa_copy_m64(_mm_sign_epi8(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
 }
 
 FORCE_INLINE __m64 _mm_sign_pi16(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.m128i = _mm_sign_epi16(va.m128i, vb.m128i);
-	return va.m64[0];
+	return v_msa_copy_m64(_mm_sign_epi16(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
 }
 
 FORCE_INLINE __m64 _mm_sign_pi32(__m64 a, __m64 b)
 {
-	VREG128 va = {.m64 = {a, {0}}};
-	VREG128 vb = {.m64 = {b, {0}}};
-	va.m128i = _mm_sign_epi32(va.m128i, vb.m128i);
-	return va.m64[0];
+	return v_msa_copy_m64(_mm_sign_epi32(
+		v_msa_fill_m64(__m128i, a), v_msa_fill_m64(__m128i, b)));
 }
 
 FORCE_INLINE __m128i _mm_alignr_epi8(__m128i a, __m128i b, int imm8)
@@ -3737,28 +6344,102 @@ FORCE_INLINE __m128i _mm_alignr_epi8(__m128i a, __m128i b, int imm8)
 		vreinterpret_v16i8(a), vreinterpret_v16i8(b), imm8));
 }
 
-__m64 _mm_alignr_pi8(__m64 a, __m64 b, int imm8)
+FORCE_INLINE __m64 _mm_alignr_pi8(__m64 a, __m64 b, int imm8)
 {
-	VREG128 v = {
-		.m64 = {b, a}
-	};
-	v16i8 z = {0};
-	v.msa_v16i8 = __builtin_msa_sld_b(z, v.msa_v16i8, imm8);
-	return v.m64[0];
+	uint64_t hi = vreinterpret_i64_m64(a);
+	uint64_t lo = vreinterpret_i64_m64(b);
+	int n = imm8 << 3;
+	if (imm8 <= 0)
+		return b;
+	else if (imm8 >= 16)
+		return vreinterpret_m64_i64(0);
+	else if (n < 64)
+		return vreinterpret_m64_i64((lo >> n) | (hi << (64 - n)));
+	return vreinterpret_m64_i64(hi >> (n - 64));
 }
 
+/*
+ * MIPS `pause` waits for LLbit to clear and is no spin hint outside an
+ * ll/sc loop, so back off with a hazard barrier (R2+) or ssnop instead.
+ */
 FORCE_INLINE void _mm_pause()
 {
-	__asm__ __volatile__("pause\n");
+#if defined(__mips) && __mips_isa_rev >= 2
+	__asm__ __volatile__("ehb" ::: "memory");
+#elif defined(__mips)
+	__asm__ __volatile__("ssnop" ::: "memory");
+#else
+	__asm__ __volatile__("" ::: "memory");
+#endif
 }
 
+#ifndef SSE2MSA_SPIN_MAX_PAUSE
+#define SSE2MSA_SPIN_MAX_PAUSE 64
+#endif
+
+/*
+ * Spin until `pred` holds, pausing 1, 2, 4 ... SSE2MSA_SPIN_MAX_PAUSE
+ * times between checks. Once `budget` pauses are spent, yield the CPU
+ * between checks instead.
+ */
+#define sse2msa_spin_wait(pred, budget)                              \
+__extension__({                                                      \
+	unsigned long _spent = 0, _n = 1;                            \
+	while (!(pred)) {                                            \
+		if (_spent >= (unsigned long)(budget)) {             \
+			sched_yield();                               \
+			continue;                                    \
+		}                                                    \
+		for (unsigned long _i = 0; _i < _n; ++_i)            \
+			_mm_pause();                                 \
+		_spent += _n;                                        \
+		if (_n < SSE2MSA_SPIN_MAX_PAUSE)                     \
+			_n <<= 1;                                    \
+	}                                                            \
+})
+
+/*
+ * x86 fences on lightweight SYNC stypes: sfence orders stores (SYNC_WMB),
+ * lfence orders loads (SYNC_RMB) and mfence orders both (SYNC_MB). Cores
+ * without the stypes execute them as SYNC 0. Define SSE2MSA_FULL_SYNC to
+ * use the portable full barrier for all three.
+ */
+#define SSE2MSA_SYNC_WMB 0x04
+#define SSE2MSA_SYNC_MB 0x10
+#define SSE2MSA_SYNC_RMB 0x13
+
+#if defined(SSE2MSA_FULL_SYNC)
+#define v_msa_sync(stype) __sync_synchronize()
+#elif defined(__mips)
+#define v_msa_sync(stype) \
+	__asm__ __volatile__("sync %0" :: "i"(stype) : "memory")
+#else
+#define v_msa_sync(stype)                                         \
+	__atomic_thread_fence((stype) == SSE2MSA_SYNC_WMB ?       \
+		__ATOMIC_RELEASE : (stype) == SSE2MSA_SYNC_RMB ?  \
+		__ATOMIC_ACQUIRE : __ATOMIC_SEQ_CST)
+#endif
+
 FORCE_INLINE void _mm_sfence(void)
 {
-    __sync_synchronize();
+	sse2msa_stream_flush();
+	v_msa_sync(SSE2MSA_SYNC_WMB);
+}
+
+FORCE_INLINE void _mm_lfence(void)
+{
+	v_msa_sync(SSE2MSA_SYNC_RMB);
+}
+
+FORCE_INLINE void _mm_mfence(void)
+{
+	sse2msa_stream_flush();
+	v_msa_sync(SSE2MSA_SYNC_MB);
 }
 
 #if defined(__GNUC__)
 #pragma pop_macro("FORCE_INLINE")
 #pragma pop_macro("ALIGN_STRUCT")
+#pragma pop_macro("SHARED_TLS")
 #endif
 #endif /* SSE2MSA_H */
@@ -0,0 +1,1598 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64)
+#include <immintrin.h>
+#elif defined(__mips)
+#include "sse2msa.h"
+#endif
+
+#define MiB (1 << 20)
+#define ALIGN_CACHE __attribute__((aligned(64)))
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Repeat so that every size moves about 1 GiB */
+static int reps_for(size_t size)
+{
+	size_t reps = 1024 * (size_t)MiB / size;
+	return reps ? reps : 1;
+}
+
+static void stream_memset(void *dst, int c, size_t n)
+{
+	__m128i v = _mm_set1_epi8(c);
+	for (size_t i = 0; i < n; i += 16)
+		_mm_stream_si128((__m128i *)((char *)dst + i), v);
+	_mm_sfence();
+}
+
+static void stream_memcpy(void *dst, void *src, size_t n)
+{
+	for (size_t i = 0; i < n; i += 16)
+		_mm_stream_si128((__m128i *)((char *)dst + i),
+			_mm_stream_load_si128((__m128i *)((char *)src + i)));
+	_mm_sfence();
+}
+
+static void bench_stream(void)
+{
+	printf("%-10s %12s %12s %12s %12s\n", "size(MiB)",
+		"memset", "stream_set", "memcpy", "stream_cpy");
+	for (size_t mib = 1; mib <= 256; mib <<= 1) {
+		size_t n = mib * MiB;
+		int reps = reps_for(n);
+		char *dst = _mm_malloc(n, 64);
+		char *src = _mm_malloc(n, 64);
+		double t[4];
+		memset(src, 1, n);
+		memset(dst, 0, n);
+
+		t[0] = now();
+		for (int r = 0; r < reps; ++r)
+			memset(dst, r, n);
+		t[0] = now() - t[0];
+		t[1] = now();
+		for (int r = 0; r < reps; ++r)
+			stream_memset(dst, r, n);
+		t[1] = now() - t[1];
+		t[2] = now();
+		for (int r = 0; r < reps; ++r)
+			memcpy(dst, src, n);
+		t[2] = now() - t[2];
+		t[3] = now();
+		for (int r = 0; r < reps; ++r)
+			stream_memcpy(dst, src, n);
+		t[3] = now() - t[3];
+
+		printf("%-10zu", mib);
+		for (int i = 0; i < 4; ++i)
+			printf(" %9.2fGB/s", (double)n * reps / t[i] / 1e9);
+		putc('\n', stdout);
+		_mm_free(src);
+		_mm_free(dst);
+	}
+}
+
+/* xorshift, good enough to shuffle benchmark inputs */
+static uint32_t rnd_state = 2463534242u;
+
+static uint32_t rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 17;
+	rnd_state ^= rnd_state << 5;
+	return rnd_state;
+}
+
+#define PREFETCH_DIST 16
+
+#define GATHER(hint)                                                   \
+({                                                                     \
+	uint64_t sum = 0;                                              \
+	for (size_t i = 0; i < n; ++i) {                               \
+		_mm_prefetch((const char *)&data[idx[i + PREFETCH_DIST]], \
+			hint);                                         \
+		sum += data[idx[i]];                                   \
+	}                                                              \
+	sum;                                                           \
+})
+
+/*
+ * Dependent chase through one random cycle of cache-line nodes. `ahead`
+ * is a jump pointer PREFETCH_DIST hops down the list, so the prefetch
+ * can run ahead of the loads that serialize on `next`.
+ */
+struct chase_node {
+	uint32_t next;
+	uint32_t ahead;
+	uint64_t pad[7];
+};
+
+#define CHASE(hint)                                                    \
+({                                                                     \
+	uint32_t p = 0;                                                \
+	for (size_t i = 0; i < nnode; ++i) {                           \
+		_mm_prefetch((const char *)&node[node[p].ahead], hint); \
+		p = node[p].next;                                      \
+	}                                                              \
+	p;                                                             \
+})
+
+#define STREAM_THEN_HOT(hint)                                          \
+({                                                                     \
+	uint64_t sum = 0;                                              \
+	for (size_t i = 0; i < n; i += 8) {                            \
+		_mm_prefetch((const char *)&data[i + 64], hint);       \
+		sum += data[i];                                        \
+	}                                                              \
+	double t = now();                                              \
+	for (size_t i = 0; i < nhot; i += 8)                           \
+		sum += hot[i];                                         \
+	hot_time += now() - t;                                         \
+	sum;                                                           \
+})
+
+static void bench_prefetch(void)
+{
+	/* random gather over 64 MiB, prefetching PREFETCH_DIST ahead */
+	size_t n = 8 * MiB, nhot = 32 * 1024;
+	uint64_t *data = _mm_malloc((n + 64) * sizeof(*data), 64);
+	uint64_t *hot = _mm_malloc(nhot * sizeof(*hot), 64);
+	uint32_t *idx = malloc((n + PREFETCH_DIST) * sizeof(*idx));
+	size_t nnode = MiB;
+	struct chase_node *node = _mm_malloc(nnode * sizeof(*node), 64);
+	volatile uint64_t sink = 0;
+	double t;
+
+	for (size_t i = 0; i < n + 64; ++i)
+		data[i] = i;
+	for (size_t i = 0; i < nhot; ++i)
+		hot[i] = i;
+	for (size_t i = 0; i < n + PREFETCH_DIST; ++i)
+		idx[i] = rnd() % n;
+
+	printf("gather, ns/access\n");
+#define RUN_GATHER(name, hint)                                     \
+	t = now();                                                 \
+	sink += GATHER(hint);                                      \
+	printf("  %-4s %8.2f\n", name, (now() - t) * 1e9 / n);
+	t = now();
+	for (size_t i = 0; i < n; ++i)
+		sink += data[idx[i]];
+	printf("  %-4s %8.2f\n", "none", (now() - t) * 1e9 / n);
+	RUN_GATHER("T0", _MM_HINT_T0);
+	RUN_GATHER("T1", _MM_HINT_T1);
+	RUN_GATHER("T2", _MM_HINT_T2);
+	RUN_GATHER("NTA", _MM_HINT_NTA);
+#undef RUN_GATHER
+
+	/* Sattolo's shuffle gives a single cycle through all 64 MiB */
+	for (size_t i = 0; i < nnode; ++i)
+		idx[i] = i;
+	for (size_t i = nnode - 1; i > 0; --i) {
+		size_t j = rnd() % i;
+		uint32_t x = idx[i];
+		idx[i] = idx[j];
+		idx[j] = x;
+	}
+	for (size_t i = 0; i < nnode; ++i)
+		node[i].next = idx[i];
+	for (size_t i = 0, p = 0; i < nnode; ++i, p = node[p].next)
+		idx[i] = p;
+	for (size_t i = 0; i < nnode; ++i)
+		node[idx[i]].ahead = idx[(i + PREFETCH_DIST) % nnode];
+
+	printf("pointer chase, ns/hop\n");
+#define RUN_CHASE(name, hint)                                      \
+	t = now();                                                 \
+	sink += CHASE(hint);                                       \
+	printf("  %-4s %8.2f\n", name, (now() - t) * 1e9 / nnode);
+	t = now();
+	{
+		uint32_t p = 0;
+		for (size_t i = 0; i < nnode; ++i)
+			p = node[p].next;
+		sink += p;
+	}
+	printf("  %-4s %8.2f\n", "none", (now() - t) * 1e9 / nnode);
+	RUN_CHASE("T0", _MM_HINT_T0);
+	RUN_CHASE("T1", _MM_HINT_T1);
+	RUN_CHASE("T2", _MM_HINT_T2);
+	RUN_CHASE("NTA", _MM_HINT_NTA);
+#undef RUN_CHASE
+
+	/* a streamed pass should leave a hot table cached with NTA only */
+	printf("hot table re-read after a 64 MiB stream, ns/line\n");
+#define RUN_STREAM(name, hint)                                     \
+	{                                                          \
+		double hot_time = 0;                               \
+		for (int r = 0; r < 8; ++r)                        \
+			sink += STREAM_THEN_HOT(hint);             \
+		printf("  %-4s %8.2f\n", name,                     \
+			hot_time * 1e9 / (8 * nhot / 8));          \
+	}
+	RUN_STREAM("T0", _MM_HINT_T0);
+	RUN_STREAM("NTA", _MM_HINT_NTA);
+#undef RUN_STREAM
+
+	_mm_free(node);
+	free(idx);
+	_mm_free(hot);
+	_mm_free(data);
+}
+
+/*
+ * Single-producer/single-consumer ring: the producer fills a batch, fences
+ * and publishes `head`; the consumer reads `head`, fences and drains.
+ */
+#define RING_SIZE 4096
+#define RING_BATCH 64
+#define RING_ITEMS (8 * MiB)
+
+static struct {
+	uint64_t slot[RING_SIZE];
+	volatile size_t head ALIGN_CACHE;
+	volatile size_t tail ALIGN_CACHE;
+	int full_sync;
+} ring;
+
+static void *ring_producer(void *arg)
+{
+	(void)arg;
+	for (size_t i = 0; i < RING_ITEMS; i += RING_BATCH) {
+		while (i + RING_BATCH - ring.tail > RING_SIZE)
+			sched_yield();
+		for (size_t j = i; j < i + RING_BATCH; ++j)
+			ring.slot[j % RING_SIZE] = j;
+		if (ring.full_sync)
+			__sync_synchronize();
+		else
+			_mm_sfence();
+		ring.head = i + RING_BATCH;
+	}
+	return NULL;
+}
+
+static uint64_t ring_consume(void)
+{
+	uint64_t sum = 0;
+	for (size_t i = 0; i < RING_ITEMS; i += RING_BATCH) {
+		while (ring.head == i)
+			sched_yield();
+		if (ring.full_sync)
+			__sync_synchronize();
+		else
+			_mm_lfence();
+		for (size_t j = i; j < i + RING_BATCH; ++j)
+			sum += ring.slot[j % RING_SIZE];
+		if (ring.full_sync)
+			__sync_synchronize();
+		else
+			_mm_mfence();
+		ring.tail = i + RING_BATCH;
+	}
+	return sum;
+}
+
+static void bench_fence(void)
+{
+	static const char *name[] = {"sfence/lfence", "full sync"};
+	for (int full = 0; full < 2; ++full) {
+		pthread_t th;
+		ring.head = ring.tail = 0;
+		ring.full_sync = full;
+		double t = now();
+		pthread_create(&th, NULL, ring_producer, NULL);
+		uint64_t sum = ring_consume();
+		pthread_join(th, NULL);
+		t = now() - t;
+		printf("  %-14s %8.2f Mitems/s%s\n", name[full],
+			RING_ITEMS / t / 1e6,
+			sum == (uint64_t)RING_ITEMS * (RING_ITEMS - 1) / 2 ?
+			"" : " (BAD SUM)");
+	}
+}
+
+/*
+ * Test-and-set lock guarding a counter, hammered by N threads for a fixed
+ * time: a plain pause loop against sse2msa_spin_wait's backoff.
+ */
+#define LOCK_SECONDS 0.25
+#define LOCK_MAX_THREADS 8
+
+static struct {
+	volatile int lock ALIGN_CACHE;
+	volatile int stop ALIGN_CACHE;
+	uint64_t counter;
+	int backoff;
+} spin;
+
+static void spin_lock(void)
+{
+	while (__atomic_exchange_n(&spin.lock, 1, __ATOMIC_ACQUIRE)) {
+#if defined(__mips)
+		if (spin.backoff) {
+			sse2msa_spin_wait(!spin.lock, 1024);
+			continue;
+		}
+#endif
+		while (spin.lock)
+			_mm_pause();
+	}
+}
+
+static void *spin_worker(void *arg)
+{
+	uint64_t *done = arg;
+	while (!spin.stop) {
+		spin_lock();
+		++spin.counter;
+		__atomic_store_n(&spin.lock, 0, __ATOMIC_RELEASE);
+		++*done;
+	}
+	return NULL;
+}
+
+static void bench_spinlock(void)
+{
+	static const char *name[] = {"pause loop", "spin_wait"};
+	for (int backoff = 0; backoff < 2; ++backoff) {
+#if !defined(__mips)
+		if (backoff)
+			break;
+#endif
+		for (int n = 1; n <= LOCK_MAX_THREADS; n <<= 1) {
+			pthread_t th[LOCK_MAX_THREADS];
+			uint64_t done[LOCK_MAX_THREADS] = {0}, total = 0;
+			spin.stop = 0;
+			spin.counter = 0;
+			spin.backoff = backoff;
+			for (int i = 0; i < n; ++i)
+				pthread_create(&th[i], NULL, spin_worker, &done[i]);
+			double t = now();
+			while (now() - t < LOCK_SECONDS)
+				sched_yield();
+			spin.stop = 1;
+			for (int i = 0; i < n; ++i) {
+				pthread_join(th[i], NULL);
+				total += done[i];
+			}
+			t = now() - t;
+			printf("  %-10s %d threads %8.2f Mlocks/s%s\n", name[backoff],
+				n, total / t / 1e6,
+				total == spin.counter ? "" : " (BAD COUNT)");
+		}
+	}
+}
+
+/*
+ * One-pole IIR on 4 channels fed a single impulse: the tail decays into
+ * denormals, which many FPUs handle in microcode or trap to software.
+ */
+#define IIR_SAMPLES (16 * MiB)
+
+static float iir_run(void)
+{
+	__m128 y = _mm_set1_ps(1.0f);
+	__m128 k = _mm_set1_ps(0.999f);
+	__m128 x = _mm_setzero_ps();
+	for (size_t i = 0; i < IIR_SAMPLES; ++i)
+		y = _mm_add_ps(_mm_mul_ps(y, k), x);
+	return _mm_cvtss_f32(y);
+}
+
+static void bench_denormal(void)
+{
+	unsigned int csr = _mm_getcsr();
+	static const char *name[] = {"FTZ/DAZ off", "FTZ/DAZ on"};
+	for (int ftz = 0; ftz < 2; ++ftz) {
+		_MM_SET_FLUSH_ZERO_MODE(ftz ? _MM_FLUSH_ZERO_ON : _MM_FLUSH_ZERO_OFF);
+		_MM_SET_DENORMALS_ZERO_MODE(ftz ?
+			_MM_DENORMALS_ZERO_ON : _MM_DENORMALS_ZERO_OFF);
+		double t = now();
+		volatile float sink = iir_run();
+		(void)sink;
+		t = now() - t;
+		printf("  %-12s %8.2f ns/sample\n", name[ftz],
+			t * 1e9 / IIR_SAMPLES);
+	}
+	_mm_setcsr(csr);
+}
+
+/*
+ * Packed string compares on a synthetic CSV-like corpus, each against the
+ * obvious scalar loop: equal-any delimiter counting, ranges (alnum)
+ * counting and a cmpestri tokenizer.
+ */
+#define TEXT_SIZE (16 * MiB)
+#define TEXT_REPS 4
+
+/* padded so the needle can be loaded whole */
+static const char text_delims[16] = ",;\"\n";
+static const char text_alnum[16] = "azAZ09";
+
+static char *text_corpus(void)
+{
+	static const char chars[] =
+		"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+		"      .-_:";
+	char *t = _mm_malloc(TEXT_SIZE + 16, 16);
+	size_t field = 0;
+	for (size_t i = 0; i < TEXT_SIZE; ++i) {
+		uint32_t r = rnd();
+		if (++field > 4 + r % 12) {
+			t[i] = text_delims[(r >> 8) % 4];
+			field = 0;
+		} else {
+			t[i] = chars[(r >> 8) % (sizeof(chars) - 1)];
+		}
+	}
+	memset(t + TEXT_SIZE, 0, 16);
+	return t;
+}
+
+static size_t scalar_delims(const char *t, size_t n)
+{
+	size_t c = 0;
+	for (size_t i = 0; i < n; ++i)
+		c += t[i] == ',' || t[i] == ';' || t[i] == '"' || t[i] == '\n';
+	return c;
+}
+
+static size_t scalar_alnum(const char *t, size_t n)
+{
+	size_t c = 0;
+	for (size_t i = 0; i < n; ++i)
+		c += (t[i] >= 'a' && t[i] <= 'z') ||
+		     (t[i] >= 'A' && t[i] <= 'Z') ||
+		     (t[i] >= '0' && t[i] <= '9');
+	return c;
+}
+
+static size_t scalar_tokens(const char *t, size_t n)
+{
+	size_t c = 0;
+	for (size_t i = 0; i < n; ++i)
+		if (strchr(text_delims, t[i]) && t[i])
+			++c;
+	return c;
+}
+
+#define SIMD_COUNT(name, set, mode)                                        \
+static size_t simd_##name(const char *t, size_t n)                        \
+{                                                                          \
+	__m128i s = _mm_loadu_si128((const __m128i *)set);                 \
+	size_t c = 0;                                                      \
+	for (size_t i = 0; i < n; i += 16) {                               \
+		int len = n - i < 16 ? (int)(n - i) : 16;                  \
+		__m128i m = _mm_cmpestrm(s, strlen(set),                   \
+			_mm_loadu_si128((const __m128i *)(t + i)), len,    \
+			_SIDD_UBYTE_OPS | (mode) | _SIDD_BIT_MASK);        \
+		c += __builtin_popcount(_mm_cvtsi128_si32(m));             \
+	}                                                                  \
+	return c;                                                          \
+}
+
+SIMD_COUNT(delims, text_delims, _SIDD_CMP_EQUAL_ANY)
+SIMD_COUNT(alnum, text_alnum, _SIDD_CMP_RANGES)
+
+#undef SIMD_COUNT
+
+/* Walk from delimiter to delimiter, as a tokenizer does */
+static size_t simd_tokens(const char *t, size_t n)
+{
+	__m128i s = _mm_loadu_si128((const __m128i *)text_delims);
+	size_t c = 0;
+	for (size_t i = 0; i < n;) {
+		int len = n - i < 16 ? (int)(n - i) : 16;
+		int k = _mm_cmpestri(s, strlen(text_delims),
+			_mm_loadu_si128((const __m128i *)(t + i)), len,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+			_SIDD_LEAST_SIGNIFICANT);
+		if (k < len)
+			++c;
+		i += k < len ? k + 1 : len;
+	}
+	return c;
+}
+
+static void bench_string(void)
+{
+	static const struct {
+		const char *name;
+		size_t (*scalar)(const char *, size_t);
+		size_t (*simd)(const char *, size_t);
+	} cases[] = {
+		{"equal-any", scalar_delims, simd_delims},
+		{"ranges", scalar_alnum, simd_alnum},
+		{"tokenize", scalar_tokens, simd_tokens},
+	};
+	char *t = text_corpus();
+	printf("%-10s %12s %12s\n", "mode", "scalar", "pcmpestr");
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+		size_t r[2] = {0, 0};
+		double ts[2];
+		for (int v = 0; v < 2; ++v) {
+			double t0 = now();
+			for (int k = 0; k < TEXT_REPS; ++k)
+				r[v] = (v ? cases[i].simd : cases[i].scalar)(
+					t, TEXT_SIZE);
+			ts[v] = now() - t0;
+		}
+		printf("%-10s %9.2f MB/s %9.2f MB/s%s\n", cases[i].name,
+			TEXT_REPS * (TEXT_SIZE / 1e6) / ts[0],
+			TEXT_REPS * (TEXT_SIZE / 1e6) / ts[1],
+			r[0] == r[1] ? "" : "  MISMATCH");
+	}
+	_mm_free(t);
+}
+
+/* CRC32-C throughput, a plain _mm_crc32_u64 chain vs the 3-stream bulk */
+#define CRC_BYTES (256 * MiB)
+
+static uint32_t crc_chain(const unsigned char *p, size_t n, uint32_t crc)
+{
+	uint64_t c = crc;
+	for (size_t i = 0; i < n; i += 8) {
+		uint64_t v;
+		memcpy(&v, p + i, 8);
+		c = _mm_crc32_u64(c, v);
+	}
+	return c;
+}
+
+static void bench_crc32(void)
+{
+	size_t max = MiB;
+	unsigned char *buf = _mm_malloc(max, 64);
+	for (size_t i = 0; i < max; ++i)
+		buf[i] = rnd();
+	printf("%-10s %12s %12s\n", "size", "chain", "bulk");
+	for (size_t n = 64; n <= max; n <<= 2) {
+		size_t reps = CRC_BYTES / n;
+		uint32_t r[2] = {0, 0};
+		double t[2] = {0, 0};
+		for (int v = 0; v < 2; ++v) {
+			uint32_t c = 0;
+			double t0 = now();
+			for (size_t k = 0; k < reps; ++k) {
+#if defined(__mips)
+				if (v)
+					c = sse2msa_crc32c(buf, n, c);
+				else
+#endif
+					c = crc_chain(buf, n, c);
+			}
+			t[v] = now() - t0;
+			r[v] = c;
+		}
+		printf("%-10zu %7.2f GB/s %7.2f GB/s%s\n", n,
+			reps * n / t[0] * 1e-9, reps * n / t[1] * 1e-9,
+			r[0] == r[1] ? "" : "  MISMATCH");
+	}
+	_mm_free(buf);
+}
+
+/*
+ * Horizontal block-matching search of a 16x16 block over 64 candidates,
+ * with _mm_sad_epu8 (one candidate per row load) and with mpsadbw (eight
+ * candidates per row).
+ */
+#define ME_STRIDE 128
+#define ME_RANGE 64
+#define ME_BLOCKS (64 * 1024)
+
+static __m128i row_sad8(const uint8_t *ref, __m128i cur)
+{
+#if defined(__mips)
+	return sse2msa_mpsadbw_row_epu8(ref, cur);
+#else
+	__m128i lo = _mm_loadu_si128((const __m128i *)ref);
+	__m128i hi = _mm_loadu_si128((const __m128i *)(ref + 8));
+	return _mm_add_epi16(
+		_mm_add_epi16(_mm_mpsadbw_epu8(lo, cur, 0),
+			_mm_mpsadbw_epu8(lo, cur, 5)),
+		_mm_add_epi16(_mm_mpsadbw_epu8(hi, cur, 2),
+			_mm_mpsadbw_epu8(hi, cur, 7)));
+#endif
+}
+
+static int me_sad(const uint8_t *ref, const __m128i *cur)
+{
+	int best = 0, best_sad = 1 << 30;
+	for (int x = 0; x < ME_RANGE; ++x) {
+		__m128i acc = _mm_setzero_si128();
+		for (int y = 0; y < 16; ++y)
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(cur[y],
+				_mm_loadu_si128((const __m128i *)
+				(ref + y * ME_STRIDE + x))));
+		int sad = _mm_cvtsi128_si32(acc) + _mm_extract_epi16(acc, 4);
+		if (sad < best_sad) {
+			best_sad = sad;
+			best = x;
+		}
+	}
+	return best;
+}
+
+static int me_mpsadbw(const uint8_t *ref, const __m128i *cur)
+{
+	int best = 0, best_sad = 1 << 30;
+	for (int x = 0; x < ME_RANGE; x += 8) {
+		__m128i acc = _mm_setzero_si128();
+		for (int y = 0; y < 16; ++y)
+			acc = _mm_add_epi16(acc,
+				row_sad8(ref + y * ME_STRIDE + x, cur[y]));
+		/* 16 rows of 16 bytes: at most 65280, no wrap */
+		__m128i m = _mm_minpos_epu16(acc);
+		int sad = _mm_extract_epi16(m, 0);
+		if (sad < best_sad) {
+			best_sad = sad;
+			best = x + _mm_extract_epi16(m, 1);
+		}
+	}
+	return best;
+}
+
+static void bench_mpsadbw(void)
+{
+	uint8_t *frame = _mm_malloc(16 * ME_STRIDE + 16, 64);
+	__m128i cur[16];
+	for (int i = 0; i < 16 * ME_STRIDE + 16; ++i)
+		frame[i] = rnd();
+	static const struct {
+		const char *name;
+		int (*fn)(const uint8_t *, const __m128i *);
+	} cases[] = {
+		{"sad_epu8", me_sad},
+		{"mpsadbw", me_mpsadbw},
+	};
+	int found[2];
+	for (size_t i = 0; i < 2; ++i) {
+		unsigned int sum = 0;
+		double t = now();
+		for (int b = 0; b < ME_BLOCKS; ++b) {
+			int x = b % ME_RANGE;
+			for (int y = 0; y < 16; ++y)
+				cur[y] = _mm_loadu_si128((const __m128i *)
+					(frame + y * ME_STRIDE + x));
+			sum += cases[i].fn(frame, cur) == x;
+		}
+		t = now() - t;
+		found[i] = sum;
+		printf("  %-10s %8.1f ns/block\n", cases[i].name,
+			t * 1e9 / ME_BLOCKS);
+	}
+	if (found[0] != found[1])
+		printf("  MISMATCH\n");
+}
+
+/*
+ * Copy many short records (1..47 bytes) into a packed output buffer: full
+ * vectors with storeu and the remainder either with a byte loop or with
+ * one masked store.
+ */
+#define TAIL_RECORDS (1 << 16)
+#define TAIL_REPS 64
+
+static size_t tail_scalar(char *dst, const char *src, const uint8_t *len)
+{
+	size_t o = 0;
+	for (int r = 0; r < TAIL_RECORDS; ++r) {
+		size_t n = len[r], i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm_storeu_si128((__m128i *)(dst + o + i),
+				_mm_loadu_si128((const __m128i *)(src + i)));
+		for (; i < n; ++i)
+			dst[o + i] = src[i];
+		o += n;
+	}
+	return o;
+}
+
+static size_t tail_maskmove(char *dst, const char *src, const uint8_t *len)
+{
+	const __m128i iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+		8, 9, 10, 11, 12, 13, 14, 15);
+	size_t o = 0;
+	for (int r = 0; r < TAIL_RECORDS; ++r) {
+		size_t n = len[r], i = 0;
+		for (; i + 16 <= n; i += 16)
+			_mm_storeu_si128((__m128i *)(dst + o + i),
+				_mm_loadu_si128((const __m128i *)(src + i)));
+		if (i < n)
+			_mm_maskmoveu_si128(
+				_mm_loadu_si128((const __m128i *)(src + i)),
+				_mm_cmpgt_epi8(_mm_set1_epi8(n - i), iota),
+				dst + o + i);
+		o += n;
+	}
+	return o;
+}
+
+static void bench_maskmove(void)
+{
+	static const struct {
+		const char *name;
+		size_t (*fn)(char *, const char *, const uint8_t *);
+	} cases[] = {
+		{"byte loop", tail_scalar},
+		{"maskmove", tail_maskmove},
+	};
+	uint8_t *len = malloc(TAIL_RECORDS);
+	char *src = _mm_malloc(64, 64);
+	char *dst[2];
+	size_t total = 0;
+	for (int r = 0; r < TAIL_RECORDS; ++r)
+		total += len[r] = 1 + rnd() % 47;
+	for (int i = 0; i < 64; ++i)
+		src[i] = i + 1;
+	for (int v = 0; v < 2; ++v) {
+		dst[v] = _mm_malloc(total + 64, 64);
+		memset(dst[v], 0, total + 64);
+		double t = now();
+		for (int k = 0; k < TAIL_REPS; ++k)
+			cases[v].fn(dst[v], src, len);
+		t = now() - t;
+		printf("  %-10s %8.2f ns/record\n", cases[v].name,
+			t * 1e9 / ((double)TAIL_REPS * TAIL_RECORDS));
+	}
+	if (memcmp(dst[0], dst[1], total + 64))
+		printf("  MISMATCH\n");
+	_mm_free(dst[0]);
+	_mm_free(dst[1]);
+	_mm_free(src);
+	free(len);
+}
+
+/*
+ * AES-128-CTR and AES-128-GCM throughput. The baseline is a generic C
+ * T-table cipher laid out like OpenSSL's aes_core.c; the intrinsic
+ * variants encrypt one counter block at a time or four at once. GCM hashes
+ * with OpenSSL's generic 4-bit table GHASH for the T-table cipher and with
+ * the carry-less multiply for the intrinsic ones.
+ */
+#define AES_BUF (16 * 1024)
+#define AES_BYTES (64 * MiB)
+
+static uint8_t aes_sbox[256];
+static uint32_t aes_te[4][256];
+
+#define ROTL8(x, s) ((uint8_t)((x) << (s) | (x) >> (8 - (s))))
+#define GETU32(p) ((uint32_t)(p)[0] << 24 | (uint32_t)(p)[1] << 16 | \
+	(uint32_t)(p)[2] << 8 | (uint32_t)(p)[3])
+#define PUTU32(p, v) ((p)[0] = (v) >> 24, (p)[1] = (v) >> 16, \
+	(p)[2] = (v) >> 8, (p)[3] = (v))
+
+static void aes_tables(void)
+{
+	/* p walks the powers of 3 and q the powers of 1/3 */
+	uint8_t p = 1, q = 1;
+	do {
+		p ^= p << 1 ^ (p & 0x80 ? 0x1b : 0);
+		q ^= q << 1;
+		q ^= q << 2;
+		q ^= q << 4;
+		q ^= q & 0x80 ? 0x09 : 0;
+		aes_sbox[p] = q ^ ROTL8(q, 1) ^ ROTL8(q, 2) ^ ROTL8(q, 3) ^
+			ROTL8(q, 4) ^ 0x63;
+	} while (p != 1);
+	aes_sbox[0] = 0x63;
+	for (int i = 0; i < 256; ++i) {
+		uint32_t s = aes_sbox[i];
+		uint32_t s2 = (s << 1 ^ (s & 0x80 ? 0x1b : 0)) & 0xff;
+		uint32_t t = s2 << 24 | s << 16 | s << 8 | (s2 ^ s);
+		for (int j = 0; j < 4; ++j, t = t >> 8 | t << 24)
+			aes_te[j][i] = t;
+	}
+}
+
+static void aes128_key_ref(uint32_t rk[44], const uint8_t *key)
+{
+	uint32_t rcon = 0x01;
+	for (int i = 0; i < 4; ++i)
+		rk[i] = GETU32(key + 4 * i);
+	for (int i = 4; i < 44; ++i) {
+		uint32_t t = rk[i - 1];
+		if (i % 4 == 0) {
+			t = (uint32_t)aes_sbox[t >> 16 & 0xff] << 24 ^
+				(uint32_t)aes_sbox[t >> 8 & 0xff] << 16 ^
+				(uint32_t)aes_sbox[t & 0xff] << 8 ^
+				aes_sbox[t >> 24] ^ rcon << 24;
+			rcon = (rcon << 1 ^ (rcon & 0x80 ? 0x1b : 0)) & 0xff;
+		}
+		rk[i] = rk[i - 4] ^ t;
+	}
+}
+
+static void aes128_encrypt_ref(const uint32_t *rk, const uint8_t *in,
+			       uint8_t *out)
+{
+	uint32_t s0 = GETU32(in) ^ rk[0], s1 = GETU32(in + 4) ^ rk[1];
+	uint32_t s2 = GETU32(in + 8) ^ rk[2], s3 = GETU32(in + 12) ^ rk[3];
+	uint32_t t0, t1, t2, t3;
+#define TE(a, b, c, d, k) (aes_te[0][(a) >> 24] ^ \
+	aes_te[1][(b) >> 16 & 0xff] ^ aes_te[2][(c) >> 8 & 0xff] ^ \
+	aes_te[3][(d) & 0xff] ^ (k))
+#define SB(a, b, c, d, k) ((uint32_t)aes_sbox[(a) >> 24] << 24 ^ \
+	(uint32_t)aes_sbox[(b) >> 16 & 0xff] << 16 ^ \
+	(uint32_t)aes_sbox[(c) >> 8 & 0xff] << 8 ^ aes_sbox[(d) & 0xff] ^ (k))
+	for (int r = 1; r < 10; ++r) {
+		rk += 4;
+		t0 = TE(s0, s1, s2, s3, rk[0]);
+		t1 = TE(s1, s2, s3, s0, rk[1]);
+		t2 = TE(s2, s3, s0, s1, rk[2]);
+		t3 = TE(s3, s0, s1, s2, rk[3]);
+		s0 = t0, s1 = t1, s2 = t2, s3 = t3;
+	}
+	rk += 4;
+	PUTU32(out, SB(s0, s1, s2, s3, rk[0]));
+	PUTU32(out + 4, SB(s1, s2, s3, s0, rk[1]));
+	PUTU32(out + 8, SB(s2, s3, s0, s1, rk[2]));
+	PUTU32(out + 12, SB(s3, s0, s1, s2, rk[3]));
+#undef TE
+#undef SB
+}
+
+static __m128i aes_expand_step(__m128i k, __m128i g)
+{
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	k = _mm_xor_si128(k, _mm_slli_si128(k, 4));
+	return _mm_xor_si128(k, _mm_shuffle_epi32(g, 0xff));
+}
+
+static void aes128_key_simd(__m128i rk[11], const uint8_t *key)
+{
+#define EXPAND(i, rcon) rk[i] = aes_expand_step(rk[i - 1], \
+	_mm_aeskeygenassist_si128(rk[i - 1], rcon))
+	rk[0] = _mm_loadu_si128((const __m128i *)key);
+	EXPAND(1, 0x01);
+	EXPAND(2, 0x02);
+	EXPAND(3, 0x04);
+	EXPAND(4, 0x08);
+	EXPAND(5, 0x10);
+	EXPAND(6, 0x20);
+	EXPAND(7, 0x40);
+	EXPAND(8, 0x80);
+	EXPAND(9, 0x1b);
+	EXPAND(10, 0x36);
+#undef EXPAND
+}
+
+static __m128i aes128_encrypt_x1(const __m128i *rk, __m128i b)
+{
+	b = _mm_xor_si128(b, rk[0]);
+	for (int r = 1; r < 10; ++r)
+		b = _mm_aesenc_si128(b, rk[r]);
+	return _mm_aesenclast_si128(b, rk[10]);
+}
+
+static void aes128_encrypt_x4(const __m128i *rk, __m128i *b)
+{
+#if defined(__mips)
+	sse2msa_aes_encrypt_x4(b, rk, 10);
+#else
+	for (int j = 0; j < 4; ++j)
+		b[j] = _mm_xor_si128(b[j], rk[0]);
+	for (int r = 1; r < 10; ++r)
+		for (int j = 0; j < 4; ++j)
+			b[j] = _mm_aesenc_si128(b[j], rk[r]);
+	for (int j = 0; j < 4; ++j)
+		b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+#endif
+}
+
+/* the cipher state of one CTR stream; the counter is the last 4 bytes */
+struct aes_ctx {
+	uint32_t rk_ref[44];
+	__m128i rk[11];
+	uint8_t iv[16];
+};
+
+static void ctr_ref(const struct aes_ctx *c, uint32_t ctr,
+		    const uint8_t *in, uint8_t *out, size_t n)
+{
+	uint8_t blk[16], ks[16];
+	memcpy(blk, c->iv, 16);
+	for (size_t i = 0; i < n; i += 16, ++ctr) {
+		PUTU32(blk + 12, ctr);
+		aes128_encrypt_ref(c->rk_ref, blk, ks);
+		for (int j = 0; j < 16; ++j)
+			out[i + j] = in[i + j] ^ ks[j];
+	}
+}
+
+static void ctr_x1(const struct aes_ctx *c, uint32_t ctr,
+		   const uint8_t *in, uint8_t *out, size_t n)
+{
+	__m128i iv = _mm_loadu_si128((const __m128i *)c->iv);
+	for (size_t i = 0; i < n; i += 16, ++ctr) {
+		__m128i b = _mm_insert_epi32(iv, __builtin_bswap32(ctr), 3);
+		b = aes128_encrypt_x1(c->rk, b);
+		_mm_storeu_si128((__m128i *)(out + i), _mm_xor_si128(b,
+			_mm_loadu_si128((const __m128i *)(in + i))));
+	}
+}
+
+static void ctr_x4(const struct aes_ctx *c, uint32_t ctr,
+		   const uint8_t *in, uint8_t *out, size_t n)
+{
+	__m128i iv = _mm_loadu_si128((const __m128i *)c->iv);
+	size_t i = 0;
+	for (; i + 64 <= n; i += 64, ctr += 4) {
+		__m128i b[4];
+		for (int j = 0; j < 4; ++j)
+			b[j] = _mm_insert_epi32(iv,
+				__builtin_bswap32(ctr + j), 3);
+		aes128_encrypt_x4(c->rk, b);
+		for (int j = 0; j < 4; ++j)
+			_mm_storeu_si128((__m128i *)(out + i + 16 * j),
+				_mm_xor_si128(b[j], _mm_loadu_si128(
+				(const __m128i *)(in + i + 16 * j))));
+	}
+	ctr_x1(c, ctr, in + i, out + i, n - i);
+}
+
+/* OpenSSL's gcm_init_4bit/gcm_gmult_4bit */
+typedef struct {
+	uint64_t hi, lo;
+} ghash_u128;
+
+/*
+ * The 4-bit table, and for the carry-less multiply H .. H^4 from
+ * sse2msa_ghash_init on MIPS or byte-reversed H for the x86 loop.
+ */
+struct ghash_key {
+	ghash_u128 tab[16];
+	__m128i h[4];
+};
+
+static const uint64_t ghash_rem_4bit[16] = {
+	0x0000ull << 48, 0x1c20ull << 48, 0x3840ull << 48, 0x2460ull << 48,
+	0x7080ull << 48, 0x6ca0ull << 48, 0x48c0ull << 48, 0x54e0ull << 48,
+	0xe100ull << 48, 0xfd20ull << 48, 0xd940ull << 48, 0xc560ull << 48,
+	0x9180ull << 48, 0x8da0ull << 48, 0xa9c0ull << 48, 0xb5e0ull << 48,
+};
+
+static void ghash_init(struct ghash_key *k, const uint8_t h[16])
+{
+	ghash_u128 *htab = k->tab;
+	ghash_u128 v = {
+		(uint64_t)GETU32(h) << 32 | GETU32(h + 4),
+		(uint64_t)GETU32(h + 8) << 32 | GETU32(h + 12),
+	};
+	htab[0].hi = htab[0].lo = 0;
+	for (int i = 8; i; i >>= 1) {
+		htab[i] = v;
+		uint64_t t = 0xe100000000000000ull & (0 - (v.lo & 1));
+		v.lo = v.hi << 63 | v.lo >> 1;
+		v.hi = v.hi >> 1 ^ t;
+	}
+	for (int i = 2; i < 16; i <<= 1)
+		for (int j = 1; j < i; ++j) {
+			htab[i + j].hi = htab[i].hi ^ htab[j].hi;
+			htab[i + j].lo = htab[i].lo ^ htab[j].lo;
+		}
+#if defined(__mips)
+	sse2msa_ghash_init(k->h, _mm_loadu_si128((const __m128i *)h));
+#else
+	k->h[0] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)h),
+		_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+			8, 9, 10, 11, 12, 13, 14, 15));
+#endif
+}
+
+/* x = (x ^ in[i]) * H over every 16-byte block of in */
+static void ghash_4bit(uint8_t x[16], const struct ghash_key *key,
+		       const uint8_t *in, size_t n)
+{
+	const ghash_u128 *htab = key->tab;
+	for (size_t i = 0; i < n; i += 16) {
+		ghash_u128 z = {0, 0};
+		for (int k = 15; k >= 0; --k) {
+			uint8_t b = x[k] ^ in[i + k];
+			for (int nib = 0; nib < 2; ++nib, b >>= 4) {
+				if (k != 15 || nib) {
+					uint64_t rem = z.lo & 0xf;
+					z.lo = z.hi << 60 | z.lo >> 4;
+					z.hi = z.hi >> 4 ^ ghash_rem_4bit[rem];
+				}
+				z.hi ^= htab[b & 0xf].hi;
+				z.lo ^= htab[b & 0xf].lo;
+			}
+		}
+		PUTU32(x, z.hi >> 32);
+		PUTU32(x + 4, z.hi);
+		PUTU32(x + 8, z.lo >> 32);
+		PUTU32(x + 12, z.lo);
+	}
+}
+
+#if !defined(__mips)
+/* reduce the byte-reversed 256-bit product hi:lo, as in Intel's gfmul */
+static __m128i ghash_reduce(__m128i lo, __m128i hi)
+{
+	__m128i t7 = _mm_srli_epi32(lo, 31), t8 = _mm_srli_epi32(hi, 31), t9;
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+	t9 = _mm_srli_si128(t7, 12);
+	lo = _mm_or_si128(lo, _mm_slli_si128(t7, 4));
+	hi = _mm_or_si128(hi, _mm_or_si128(_mm_slli_si128(t8, 4), t9));
+	t7 = _mm_xor_si128(_mm_slli_epi32(lo, 31),
+		_mm_xor_si128(_mm_slli_epi32(lo, 30), _mm_slli_epi32(lo, 25)));
+	t8 = _mm_srli_si128(t7, 4);
+	lo = _mm_xor_si128(lo, _mm_slli_si128(t7, 12));
+	t9 = _mm_xor_si128(_mm_srli_epi32(lo, 1),
+		_mm_xor_si128(_mm_srli_epi32(lo, 2), _mm_srli_epi32(lo, 7)));
+	return _mm_xor_si128(hi, _mm_xor_si128(lo, _mm_xor_si128(t9, t8)));
+}
+#endif
+
+/* one carry-less multiply and reduction per block */
+static void ghash_clmul1(uint8_t x[16], const struct ghash_key *key,
+			 const uint8_t *in, size_t n)
+{
+	__m128i y = _mm_loadu_si128((const __m128i *)x);
+#if defined(__mips)
+	for (size_t i = 0; i < n; i += 16)
+		y = sse2msa_ghash(y, key->h, in + i, 16);
+#else
+	const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+		8, 9, 10, 11, 12, 13, 14, 15);
+	__m128i h = key->h[0];
+	y = _mm_shuffle_epi8(y, rev);
+	for (size_t i = 0; i < n; i += 16) {
+		__m128i a = _mm_xor_si128(y, _mm_shuffle_epi8(
+			_mm_loadu_si128((const __m128i *)(in + i)), rev));
+		__m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, h, 0x01),
+			_mm_clmulepi64_si128(a, h, 0x10));
+		y = ghash_reduce(_mm_xor_si128(_mm_clmulepi64_si128(a, h, 0x00),
+			_mm_slli_si128(mid, 8)), _mm_xor_si128(
+			_mm_clmulepi64_si128(a, h, 0x11), _mm_srli_si128(mid, 8)));
+	}
+	y = _mm_shuffle_epi8(y, rev);
+#endif
+	_mm_storeu_si128((__m128i *)x, y);
+}
+
+/* four blocks per reduction with sse2msa_ghash */
+static void ghash_clmul4(uint8_t x[16], const struct ghash_key *key,
+			 const uint8_t *in, size_t n)
+{
+#if defined(__mips)
+	_mm_storeu_si128((__m128i *)x, sse2msa_ghash(
+		_mm_loadu_si128((const __m128i *)x), key->h, in, n));
+#else
+	ghash_clmul1(x, key, in, n);
+#endif
+}
+
+typedef void (*ghash_fn)(uint8_t x[16], const struct ghash_key *,
+			 const uint8_t *, size_t);
+
+typedef void (*ctr_fn)(const struct aes_ctx *, uint32_t,
+		       const uint8_t *, uint8_t *, size_t);
+
+/* GCM with a 96-bit IV and no AAD; n is a multiple of 16 */
+static void gcm_encrypt(ctr_fn ctr, ghash_fn ghash, const struct aes_ctx *c,
+			const struct ghash_key *key, const uint8_t *in,
+			uint8_t *out, size_t n, uint8_t tag[16])
+{
+	uint8_t x[16] = {0}, len[16] = {0};
+	ctr(c, 2, in, out, n);
+	ghash(x, key, out, n);
+	PUTU32(len + 8, (uint64_t)n * 8 >> 32);
+	PUTU32(len + 12, (uint64_t)n * 8);
+	ghash(x, key, len, 16);
+	ctr(c, 1, x, tag, 16);
+}
+
+static void bench_aes(void)
+{
+	static const struct {
+		const char *name;
+		ctr_fn fn;
+		ghash_fn ghash;
+	} cases[] = {
+		{"T-table", ctr_ref, ghash_4bit},
+		{"aes x1", ctr_x1, ghash_clmul1},
+		{"aes x4", ctr_x4, ghash_clmul4},
+	};
+	struct aes_ctx c;
+	struct ghash_key gk;
+	uint8_t key[16], h[16], zero[16] = {0}, tag[3][16];
+	uint8_t *in = _mm_malloc(AES_BUF, 64);
+	uint8_t *out[3];
+	size_t reps = AES_BYTES / AES_BUF;
+	aes_tables();
+	for (int i = 0; i < 16; ++i)
+		key[i] = rnd(), c.iv[i] = rnd();
+	for (int i = 0; i < AES_BUF; ++i)
+		in[i] = rnd();
+	aes128_key_ref(c.rk_ref, key);
+	aes128_key_simd(c.rk, key);
+	aes128_encrypt_ref(c.rk_ref, zero, h);
+	ghash_init(&gk, h);
+	printf("%-10s %12s %12s\n", "", "ctr", "gcm");
+	for (int v = 0; v < 3; ++v) {
+		double t[2];
+		out[v] = _mm_malloc(AES_BUF, 64);
+		t[0] = now();
+		for (size_t k = 0; k < reps; ++k)
+			cases[v].fn(&c, 2, in, out[v], AES_BUF);
+		t[0] = now() - t[0];
+		t[1] = now();
+		for (size_t k = 0; k < reps; ++k)
+			gcm_encrypt(cases[v].fn, cases[v].ghash, &c, &gk,
+				in, out[v], AES_BUF, tag[v]);
+		t[1] = now() - t[1];
+		printf("%-10s %7.1f MB/s %7.1f MB/s%s\n", cases[v].name,
+			AES_BYTES / t[0] * 1e-6, AES_BYTES / t[1] * 1e-6,
+			!v || (!memcmp(out[0], out[v], AES_BUF) &&
+			!memcmp(tag[0], tag[v], 16)) ? "" : "  MISMATCH");
+	}
+	for (int v = 0; v < 3; ++v)
+		_mm_free(out[v]);
+	_mm_free(in);
+}
+
+/*
+ * GHASH with the 4-bit table and with the carry-less multiply, one or four
+ * blocks per reduction, and CRC32-C as a crc32 chain and folded four
+ * 128-bit lanes at a time with the carry-less multiply.
+ */
+#define CLMUL_BYTES (64 * MiB)
+
+/* fold by 512 bits, then by 128 bits; n is a multiple of 64 */
+static uint32_t crc_fold(const unsigned char *p, size_t n, uint32_t crc)
+{
+	const __m128i k512 = _mm_set_epi64x(0x9e4addf8, 0x740eef02);
+	const __m128i k128 = _mm_set_epi64x(0x493c7d27, 0xf20c0dfe);
+	__m128i x[4];
+	uint64_t c;
+	for (int j = 0; j < 4; ++j)
+		x[j] = _mm_loadu_si128((const __m128i *)p + j);
+	x[0] = _mm_xor_si128(x[0], _mm_cvtsi32_si128(crc));
+	for (p += 64, n -= 64; n; p += 64, n -= 64)
+		for (int j = 0; j < 4; ++j)
+			x[j] = _mm_xor_si128(_mm_xor_si128(
+				_mm_clmulepi64_si128(x[j], k512, 0x00),
+				_mm_clmulepi64_si128(x[j], k512, 0x11)),
+				_mm_loadu_si128((const __m128i *)p + j));
+	for (int j = 1; j < 4; ++j)
+		x[0] = _mm_xor_si128(_mm_xor_si128(
+			_mm_clmulepi64_si128(x[0], k128, 0x00),
+			_mm_clmulepi64_si128(x[0], k128, 0x11)), x[j]);
+	c = _mm_crc32_u64(0, _mm_cvtsi128_si64(x[0]));
+	return _mm_crc32_u64(c, _mm_extract_epi64(x[0], 1));
+}
+
+static void bench_clmul(void)
+{
+	static const struct {
+		const char *name;
+		ghash_fn fn;
+	} ghash[] = {
+		{"4-bit", ghash_4bit},
+		{"clmul x1", ghash_clmul1},
+		{"clmul x4", ghash_clmul4},
+	};
+	size_t max = MiB;
+	unsigned char *buf = _mm_malloc(max, 64);
+	struct ghash_key gk;
+	uint8_t h[16], x[3][16];
+	for (size_t i = 0; i < max; ++i)
+		buf[i] = rnd();
+	for (int i = 0; i < 16; ++i)
+		h[i] = rnd();
+	ghash_init(&gk, h);
+	printf("ghash, %d KiB\n", AES_BUF / 1024);
+	for (int v = 0; v < 3; ++v) {
+		size_t reps = CLMUL_BYTES / AES_BUF;
+		double t = now();
+		memset(x[v], 0, 16);
+		for (size_t k = 0; k < reps; ++k)
+			ghash[v].fn(x[v], &gk, buf, AES_BUF);
+		t = now() - t;
+		printf("  %-10s %7.2f GB/s%s\n", ghash[v].name,
+			CLMUL_BYTES / t * 1e-9,
+			memcmp(x[0], x[v], 16) ? "  MISMATCH" : "");
+	}
+	printf("%-10s %12s %12s\n", "crc32c", "chain", "fold");
+	for (size_t n = 64; n <= max; n <<= 2) {
+		size_t reps = CLMUL_BYTES / n;
+		uint32_t r[2] = {0, 0};
+		double t[2];
+		for (int v = 0; v < 2; ++v) {
+			uint32_t c = 0;
+			double t0 = now();
+			for (size_t k = 0; k < reps; ++k)
+				c = v ? crc_fold(buf, n, c) : crc_chain(buf, n, c);
+			t[v] = now() - t0;
+			r[v] = c;
+		}
+		printf("%-10zu %7.2f GB/s %7.2f GB/s%s\n", n,
+			reps * n / t[0] * 1e-9, reps * n / t[1] * 1e-9,
+			r[0] == r[1] ? "" : "  MISMATCH");
+	}
+	_mm_free(buf);
+}
+
+/*
+ * SHA-256 of 4 KiB objects: the FIPS 180-4 scalar reference, the SHA
+ * intrinsics one object at a time, and on MIPS the multi-buffer
+ * sse2msa_sha256_x4 four objects at a time.
+ */
+#define SHA_OBJ 4096
+#define SHA_OBJS 256
+#define SHA_BYTES (64 * MiB)
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t sha256_iv[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define ROR32(x, n) ((x) >> (n) | (x) << (32 - (n)))
+
+static void sha256_blocks_ref(uint32_t st[8], const uint8_t *p, size_t nblk)
+{
+	for (; nblk--; p += 64) {
+		uint32_t w[64], a = st[0], b = st[1], c = st[2], d = st[3];
+		uint32_t e = st[4], f = st[5], g = st[6], h = st[7];
+		for (int t = 0; t < 16; ++t)
+			w[t] = GETU32(p + 4 * t);
+		for (int t = 16; t < 64; ++t)
+			w[t] = w[t - 16] + w[t - 7] +
+				(ROR32(w[t - 15], 7) ^ ROR32(w[t - 15], 18) ^
+				 w[t - 15] >> 3) +
+				(ROR32(w[t - 2], 17) ^ ROR32(w[t - 2], 19) ^
+				 w[t - 2] >> 10);
+		for (int t = 0; t < 64; ++t) {
+			uint32_t t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^
+				ROR32(e, 25)) + ((e & f) ^ (~e & g)) +
+				sha256_k[t] + w[t];
+			uint32_t t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^
+				ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g;
+			g = f;
+			f = e;
+			e = d + t1;
+			d = c;
+			c = b;
+			b = a;
+			a = t1 + t2;
+		}
+		st[0] += a;
+		st[1] += b;
+		st[2] += c;
+		st[3] += d;
+		st[4] += e;
+		st[5] += f;
+		st[6] += g;
+		st[7] += h;
+	}
+}
+
+/* the usual ABEF/CDGH layout of the SHA-256 intrinsics */
+static void sha256_blocks_ni(uint32_t st[8], const uint8_t *p, size_t nblk)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bull,
+		0x0405060700010203ull);
+	__m128i t = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *)st), 0xb1);
+	__m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *)(st + 4)),
+		0x1b);
+	__m128i s0 = _mm_alignr_epi8(t, s1, 8);
+	s1 = _mm_blend_epi16(s1, t, 0xf0);
+	for (; nblk--; p += 64) {
+		__m128i abef = s0, cdgh = s1, msg[4];
+		for (int i = 0; i < 16; ++i) {
+			__m128i m;
+			if (i < 4) {
+				msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+					(const __m128i *)(p + 16 * i)), bswap);
+			} else {
+				m = _mm_add_epi32(_mm_sha256msg1_epu32(
+					msg[i % 4], msg[(i + 1) % 4]),
+					_mm_alignr_epi8(msg[(i + 3) % 4],
+					msg[(i + 2) % 4], 4));
+				msg[i % 4] = _mm_sha256msg2_epu32(m,
+					msg[(i + 3) % 4]);
+			}
+			m = _mm_add_epi32(msg[i % 4], _mm_loadu_si128(
+				(const __m128i *)(sha256_k + 4 * i)));
+			s1 = _mm_sha256rnds2_epu32(s1, s0, m);
+			s0 = _mm_sha256rnds2_epu32(s0, s1,
+				_mm_shuffle_epi32(m, 0x0e));
+		}
+		s0 = _mm_add_epi32(s0, abef);
+		s1 = _mm_add_epi32(s1, cdgh);
+	}
+	t = _mm_shuffle_epi32(s0, 0x1b);
+	s1 = _mm_shuffle_epi32(s1, 0xb1);
+	_mm_storeu_si128((__m128i *)st, _mm_blend_epi16(t, s1, 0xf0));
+	_mm_storeu_si128((__m128i *)(st + 4), _mm_alignr_epi8(s1, t, 8));
+}
+
+typedef void (*sha256_fn)(uint32_t[8], const uint8_t *, size_t);
+
+/* the final one or two blocks of an n-byte message */
+static size_t sha256_tail(uint8_t tail[128], const uint8_t *p, size_t n)
+{
+	size_t r = n % 64, len = r < 56 ? 64 : 128;
+	memset(tail, 0, len);
+	memcpy(tail, p + n - r, r);
+	tail[r] = 0x80;
+	PUTU32(tail + len - 8, (uint64_t)n * 8 >> 32);
+	PUTU32(tail + len - 4, (uint64_t)n * 8);
+	return len / 64;
+}
+
+static void sha256(sha256_fn blocks, const uint8_t *p, size_t n,
+		   uint8_t out[32])
+{
+	uint32_t st[8];
+	uint8_t tail[128];
+	memcpy(st, sha256_iv, sizeof(st));
+	blocks(st, p, n / 64);
+	blocks(st, tail, sha256_tail(tail, p, n));
+	for (int i = 0; i < 8; ++i)
+		PUTU32(out + 4 * i, st[i]);
+}
+
+static void sha256_obj_ref(const uint8_t *p, size_t n, uint8_t out[4][32])
+{
+	for (int j = 0; j < 4; ++j)
+		sha256(sha256_blocks_ref, p + j * n, n, out[j]);
+}
+
+static void sha256_obj_ni(const uint8_t *p, size_t n, uint8_t out[4][32])
+{
+	for (int j = 0; j < 4; ++j)
+		sha256(sha256_blocks_ni, p + j * n, n, out[j]);
+}
+
+/* four consecutive n-byte objects in lockstep */
+static void sha256_obj_x4(const uint8_t *p, size_t n, uint8_t out[4][32])
+{
+#if defined(__mips)
+	uint8_t tail[4][128];
+	const void *blk[4];
+	__m128i st[8];
+	size_t nt = 0;
+	sse2msa_sha256_init_x4(st);
+	for (size_t i = 0; i + 64 <= n; i += 64) {
+		for (int j = 0; j < 4; ++j)
+			blk[j] = p + j * n + i;
+		sse2msa_sha256_x4(st, blk);
+	}
+	for (int j = 0; j < 4; ++j)
+		nt = sha256_tail(tail[j], p + j * n, n);
+	for (size_t i = 0; i < nt; ++i) {
+		for (int j = 0; j < 4; ++j)
+			blk[j] = tail[j] + 64 * i;
+		sse2msa_sha256_x4(st, blk);
+	}
+	sse2msa_sha256_digest_x4(st, out);
+#else
+	sha256_obj_ni(p, n, out);
+#endif
+}
+
+static void bench_sha256(void)
+{
+	static const struct {
+		const char *name;
+		void (*fn)(const uint8_t *, size_t, uint8_t[4][32]);
+	} cases[] = {
+		{"scalar", sha256_obj_ref},
+		{"sha-ni", sha256_obj_ni},
+		{"x4", sha256_obj_x4},
+	};
+	uint8_t *buf = _mm_malloc(SHA_OBJ * SHA_OBJS, 64);
+	uint8_t (*dig)[SHA_OBJS][32] = malloc(3 * sizeof(*dig));
+	size_t reps = SHA_BYTES / (SHA_OBJ * SHA_OBJS);
+	for (size_t i = 0; i < SHA_OBJ * SHA_OBJS; ++i)
+		buf[i] = rnd();
+	printf("%d-byte objects\n", SHA_OBJ);
+	for (int v = 0; v < 3; ++v) {
+		double t = now();
+		for (size_t k = 0; k < reps; ++k)
+			for (int o = 0; o < SHA_OBJS; o += 4)
+				cases[v].fn(buf + (size_t)o * SHA_OBJ, SHA_OBJ,
+					(uint8_t (*)[32])dig[v][o]);
+		t = now() - t;
+		printf("  %-10s %8.1f MB/s%s\n", cases[v].name,
+			SHA_BYTES / t * 1e-6,
+			memcmp(dig[0], dig[v], sizeof(*dig)) ? "  MISMATCH" : "");
+	}
+	free(dig);
+	_mm_free(buf);
+}
+
+/*
+ * SGEMM micro-kernel: C (M x N) = A (M x K) * B (K x N) from pre-packed
+ * panels, each 4 x 8 tile of C kept in eight accumulators. A holds 4-row
+ * column slivers, B 8-column row slivers. Entries are multiples of 1/4 in
+ * [-2, 2), so every variant is exact and must agree bit for bit. The
+ * Makefile builds bench with -ffp-contract=off so that the compiler does
+ * not fuse the mul+add variant on its own.
+ */
+#define GEMM_M 128
+#define GEMM_N 128
+#define GEMM_K 256
+#define GEMM_FLOP (2.0 * GEMM_M * GEMM_N * GEMM_K)
+#define GEMM_REPS 256
+
+static void gemm_ref(float *c, const float *ap, const float *bp)
+{
+	for (int i = 0; i < GEMM_M; i += 4)
+		for (int j = 0; j < GEMM_N; j += 8) {
+			const float *a = ap + i * GEMM_K, *b = bp + j * GEMM_K;
+			for (int r = 0; r < 4; ++r)
+				for (int s = 0; s < 8; ++s) {
+					float acc = 0;
+					for (int k = 0; k < GEMM_K; ++k)
+						acc += a[4 * k + r] * b[8 * k + s];
+					c[(i + r) * GEMM_N + j + s] = acc;
+				}
+		}
+}
+
+static inline __m128 madd_split(__m128 a, __m128 b, __m128 c)
+{
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+static inline __m128 madd_fused(__m128 a, __m128 b, __m128 c)
+{
+	return _mm_fmadd_ps(a, b, c);
+}
+
+static inline __attribute__((always_inline)) void
+gemm_kernel(float *c, const float *ap, const float *bp,
+	    __m128 (*madd)(__m128, __m128, __m128))
+{
+	for (int i = 0; i < GEMM_M; i += 4)
+		for (int j = 0; j < GEMM_N; j += 8) {
+			const float *a = ap + i * GEMM_K, *b = bp + j * GEMM_K;
+			__m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+			__m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+			__m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+			__m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+			for (int k = 0; k < GEMM_K; ++k, a += 4, b += 8) {
+				__m128 b0 = _mm_load_ps(b), b1 = _mm_load_ps(b + 4);
+				__m128 x = _mm_set1_ps(a[0]);
+				c00 = madd(x, b0, c00);
+				c01 = madd(x, b1, c01);
+				x = _mm_set1_ps(a[1]);
+				c10 = madd(x, b0, c10);
+				c11 = madd(x, b1, c11);
+				x = _mm_set1_ps(a[2]);
+				c20 = madd(x, b0, c20);
+				c21 = madd(x, b1, c21);
+				x = _mm_set1_ps(a[3]);
+				c30 = madd(x, b0, c30);
+				c31 = madd(x, b1, c31);
+			}
+			float *t = c + i * GEMM_N + j;
+			_mm_storeu_ps(t, c00);
+			_mm_storeu_ps(t + 4, c01);
+			_mm_storeu_ps(t + GEMM_N, c10);
+			_mm_storeu_ps(t + GEMM_N + 4, c11);
+			_mm_storeu_ps(t + 2 * GEMM_N, c20);
+			_mm_storeu_ps(t + 2 * GEMM_N + 4, c21);
+			_mm_storeu_ps(t + 3 * GEMM_N, c30);
+			_mm_storeu_ps(t + 3 * GEMM_N + 4, c31);
+		}
+}
+
+static void gemm_split(float *c, const float *ap, const float *bp)
+{
+	gemm_kernel(c, ap, bp, madd_split);
+}
+
+static void gemm_fused(float *c, const float *ap, const float *bp)
+{
+	gemm_kernel(c, ap, bp, madd_fused);
+}
+
+static void bench_gemm(void)
+{
+	static const struct {
+		const char *name;
+		void (*fn)(float *, const float *, const float *);
+	} cases[] = {
+		{"scalar", gemm_ref},
+		{"mul+add", gemm_split},
+		{"fmadd", gemm_fused},
+	};
+	float *ap = _mm_malloc(GEMM_M * GEMM_K * sizeof(float), 64);
+	float *bp = _mm_malloc(GEMM_K * GEMM_N * sizeof(float), 64);
+	float *c = _mm_malloc(3 * GEMM_M * GEMM_N * sizeof(float), 64);
+	for (int i = 0; i < GEMM_M * GEMM_K; ++i)
+		ap[i] = (int)(rnd() % 16 - 8) * 0.25f;
+	for (int i = 0; i < GEMM_K * GEMM_N; ++i)
+		bp[i] = (int)(rnd() % 16 - 8) * 0.25f;
+	printf("%dx%dx%d\n", GEMM_M, GEMM_N, GEMM_K);
+	for (int v = 0; v < 3; ++v) {
+		float *cv = c + v * GEMM_M * GEMM_N;
+		double t = now();
+		for (int r = 0; r < GEMM_REPS; ++r)
+			cases[v].fn(cv, ap, bp);
+		t = now() - t;
+		printf("  %-10s %8.2f GFLOP/s%s\n", cases[v].name,
+			GEMM_FLOP * GEMM_REPS / t * 1e-9,
+			memcmp(c, cv, GEMM_M * GEMM_N * sizeof(float)) ?
+			"  MISMATCH" : "");
+	}
+	_mm_free(c);
+	_mm_free(bp);
+	_mm_free(ap);
+}
+
+static const struct {
+	const char *name;
+	void (*fn)(void);
+} benches[] = {
+	{"stream", bench_stream},
+	{"prefetch", bench_prefetch},
+	{"fence", bench_fence},
+	{"spinlock", bench_spinlock},
+	{"denormal", bench_denormal},
+	{"string", bench_string},
+	{"crc32", bench_crc32},
+	{"mpsadbw", bench_mpsadbw},
+	{"maskmove", bench_maskmove},
+	{"aes", bench_aes},
+	{"clmul", bench_clmul},
+	{"sha256", bench_sha256},
+	{"gemm", bench_gemm},
+};
+
+#define NBENCH (sizeof(benches) / sizeof(benches[0]))
+
+/* usage: bench [name...], runs every benchmark when no name is given */
+int main(int argc, char **argv)
+{
+	for (size_t i = 0; i < NBENCH; ++i) {
+		int run = argc < 2;
+		for (int j = 1; j < argc; ++j)
+			run |= !strcmp(argv[j], benches[i].name);
+		if (!run)
+			continue;
+		printf("== %s\n", benches[i].name);
+		benches[i].fn();
+	}
+	return 0;
+}
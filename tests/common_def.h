@@ -32,6 +32,9 @@ static __m128d _m128d[BUFSIZ >> 4];
 #define _immi8_0x1c 0x1c
 #define _immi8_0x02 0x02
 #define _immi8_0x01 0x01
+#define _immi8_0x11 0x11
+#define _immi8_0x03 0x03
+#define _immi8_0x00 0x00
 #define _immi32_0x01 0x01
 
 static void init_mem(void *p, size_t size)
@@ -134,6 +137,26 @@ do {                                          \
 	putc('\n', stdout);                   \
 } while(0);
 
+#define V_M128I_M128I_VP(fmt, op) \
+do {                                                      \
+	printf("%d: " # op, ++insts);                     \
+	putc('\t', stdout);                               \
+	init_mem(buffer_a, sizeof(buffer_a));             \
+	op(_m128i[2], _mm_slli_epi16(_m128i[0], 7), vp_a); \
+	PRINT128_ ## fmt(vp_a);                           \
+	putc('\n', stdout);                               \
+} while(0);
+
+#define V_M64_M64_VP(fmt, op) \
+do {                                                                        \
+	printf("%d: " # op, ++insts);                                       \
+	putc('\t', stdout);                                                 \
+	init_mem(buffer_a, sizeof(buffer_a));                               \
+	op(_m64[2], _mm_movepi64_pi64(_mm_slli_epi16(_m128i[0], 7)), vp_a); \
+	PRINT128_ ## fmt(vp_a);                                             \
+	putc('\n', stdout);                                                 \
+} while(0);
+
 #define V_I32P_I32(fmt, op) \
 do {                                      \
 	printf("%d: " # op, ++insts);     \
@@ -347,6 +370,41 @@ do {                                     \
 	putc('\n', stdout);              \
 } while(0);
 
+#define I32_M128I_M128I_IMMI8(fmt, op, imm) \
+do {                                          \
+	printf("%d: " # op, ++insts);         \
+	putc('\t', stdout);                   \
+	int a[4];                             \
+       	a[0] = op(_m128i[0], _m128i[1], imm); \
+       	a[1] = op(_m128i[2], _m128i[3], imm); \
+       	a[2] = op(_m128i[4], _m128i[5], imm); \
+       	a[3] = op(_m128i[6], _m128i[7], imm); \
+	PRINT128_ ## fmt(a);                  \
+	putc('\n', stdout);                   \
+} while(0);
+
+#define I32_M128I_I32_M128I_I32_IMMI8(fmt, op, imm) \
+do {                                                  \
+	printf("%d: " # op, ++insts);                 \
+	putc('\t', stdout);                           \
+	int a[4];                                     \
+       	a[0] = op(_m128i[0], 3, _m128i[1], 16, imm);  \
+       	a[1] = op(_m128i[2], -5, _m128i[3], 7, imm);  \
+       	a[2] = op(_m128i[4], 0, _m128i[5], -20, imm); \
+       	a[3] = op(_m128i[6], 17, _m128i[7], 1, imm);  \
+	PRINT128_ ## fmt(a);                          \
+	putc('\n', stdout);                           \
+} while(0);
+
+#define M128I_M128I_I32_M128I_I32_IMMI8(fmt, op, imm) \
+do {                                                         \
+	printf("%d: " # op, ++insts);                        \
+	putc('\t', stdout);                                  \
+	__m128i a = op(_m128i[0], 5, _m128i[1], 12, imm);    \
+	PRINT128_ ## fmt(&a);                                \
+	putc('\n', stdout);                                  \
+} while(0);
+
 #define I32_M128D_M128D(fmt, op) \
 do {                                     \
 	printf("%d: " # op, ++insts);    \
@@ -549,6 +607,30 @@ do {                                  \
 	putc('\n', stdout);           \
 } while(0);
 
+#define U32_U32_U32(fmt, op) \
+do {                                   \
+	printf("%d: " # op, ++insts);  \
+	putc('\t', stdout);            \
+	uint32_t a[4];                 \
+	a[0] = op(_u32[0], _u32[4]);   \
+	a[1] = op(_u32[1], _u32[5]);   \
+	a[2] = op(_u32[2], _u32[6]);   \
+	a[3] = op(_u32[3], _u32[7]);   \
+	PRINT128_ ## fmt(a);           \
+	putc('\n', stdout);            \
+} while(0);
+
+#define U64_U64_U64(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	uint64_t a[2];                \
+	a[0] = op(_i64[0], _i64[2]);  \
+	a[1] = op(_i64[1], _i64[3]);  \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
 #define I64_U64(fmt, op) \
 do {                                  \
 	printf("%d: " # op, ++insts); \
@@ -632,6 +714,85 @@ do {                                  \
 	putc('\n', stdout);           \
 } while(0);
 
+#define M64_V(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	__m64 a[2];                   \
+	a[0] = op();                  \
+	a[1] = op();                  \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
+#define M64_I32(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	__m64 a[2];                   \
+	a[0] = op(_i32[0]);           \
+	a[1] = op(_i32[5]);           \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
+#define M64_I64(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	__m64 a[2];                   \
+	a[0] = op(_i64[0]);           \
+	a[1] = op(_i64[1]);           \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
+#define I64_M64(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	int64_t a[2];                 \
+	a[0] = op(_m64[0]);           \
+	a[1] = op(_m64[1]);           \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
+#define M64_I8x8(fmt, op) \
+do {                                                       \
+	printf("%d: " # op, ++insts);                      \
+	putc('\t', stdout);                                \
+	__m64 a[2];                                        \
+	a[0] = op(_i8[0], _i8[1], _i8[2], _i8[3],          \
+		_i8[4], _i8[5], _i8[6], _i8[7]);           \
+	a[1] = op(_i8[8], _i8[9], _i8[10], _i8[11],        \
+		_i8[12], _i8[13], _i8[14], _i8[15]);       \
+	PRINT128_ ## fmt(a);                               \
+	putc('\n', stdout);                                \
+} while(0);
+
+#define M64_I16x4(fmt, op) \
+do {                                                   \
+	printf("%d: " # op, ++insts);                  \
+	putc('\t', stdout);                            \
+	__m64 a[2];                                    \
+	a[0] = op(_i16[0], _i16[1], _i16[2], _i16[3]); \
+	a[1] = op(_i16[4], _i16[5], _i16[6], _i16[7]); \
+	PRINT128_ ## fmt(a);                           \
+	putc('\n', stdout);                            \
+} while(0);
+
+#define M64_I32x2(fmt, op) \
+do {                                  \
+	printf("%d: " # op, ++insts); \
+	putc('\t', stdout);           \
+	__m64 a[2];                   \
+	a[0] = op(_i32[0], _i32[1]);  \
+	a[1] = op(_i32[2], _i32[3]);  \
+	PRINT128_ ## fmt(a);          \
+	putc('\n', stdout);           \
+} while(0);
+
 #define M64_M64(fmt, op) \
 do {                                  \
 	printf("%d: " # op, ++insts); \
@@ -16,6 +16,71 @@ int main()
 	test_data_init();
 	V_VP_IMMI32             (HEX, _mm_prefetch, _immi32_0x01);
 	M128I_V                 (HEX, _mm_setzero_si128);
+	V_TEST                  (_mm_empty);
+	M64_V                   (HEX, _mm_setzero_si64);
+	M64_I32                 (HEX, _mm_cvtsi32_si64);
+	I32_M64                 (HEX, _mm_cvtsi64_si32);
+	M64_I64                 (HEX, _mm_cvtsi64_m64);
+	I64_M64                 (HEX, _mm_cvtm64_si64);
+	M64_I8x8                (HEX, _mm_set_pi8);
+	M64_I16x4               (HEX, _mm_set_pi16);
+	M64_I32x2               (HEX, _mm_set_pi32);
+	M64_I8x8                (HEX, _mm_setr_pi8);
+	M64_I16x4               (HEX, _mm_setr_pi16);
+	M64_I32x2               (HEX, _mm_setr_pi32);
+	M64_I32                 (HEX, _mm_set1_pi8);
+	M64_I32                 (HEX, _mm_set1_pi16);
+	M64_I32                 (HEX, _mm_set1_pi32);
+	M64_M64_M64             (HEX, _mm_add_pi8);
+	M64_M64_M64             (HEX, _mm_add_pi16);
+	M64_M64_M64             (HEX, _mm_add_pi32);
+	M64_M64_M64             (HEX, _mm_adds_pi8);
+	M64_M64_M64             (HEX, _mm_adds_pi16);
+	M64_M64_M64             (HEX, _mm_adds_pu8);
+	M64_M64_M64             (HEX, _mm_adds_pu16);
+	M64_M64_M64             (HEX, _mm_sub_pi8);
+	M64_M64_M64             (HEX, _mm_sub_pi16);
+	M64_M64_M64             (HEX, _mm_sub_pi32);
+	M64_M64_M64             (HEX, _mm_subs_pi8);
+	M64_M64_M64             (HEX, _mm_subs_pi16);
+	M64_M64_M64             (HEX, _mm_subs_pu8);
+	M64_M64_M64             (HEX, _mm_subs_pu16);
+	M64_M64_M64             (HEX, _mm_madd_pi16);
+	M64_M64_M64             (HEX, _mm_cmpeq_pi8);
+	M64_M64_M64             (HEX, _mm_cmpeq_pi16);
+	M64_M64_M64             (HEX, _mm_cmpeq_pi32);
+	M64_M64_M64             (HEX, _mm_cmpgt_pi8);
+	M64_M64_M64             (HEX, _mm_cmpgt_pi16);
+	M64_M64_M64             (HEX, _mm_cmpgt_pi32);
+	M64_M64_M64             (HEX, _mm_unpacklo_pi8);
+	M64_M64_M64             (HEX, _mm_unpacklo_pi16);
+	M64_M64_M64             (HEX, _mm_unpacklo_pi32);
+	M64_M64_M64             (HEX, _mm_unpackhi_pi8);
+	M64_M64_M64             (HEX, _mm_unpackhi_pi16);
+	M64_M64_M64             (HEX, _mm_unpackhi_pi32);
+	M64_M64_M64             (HEX, _mm_packs_pi16);
+	M64_M64_M64             (HEX, _mm_packs_pi32);
+	M64_M64_M64             (HEX, _mm_packs_pu16);
+	M64_M64_M64             (HEX, _mm_and_si64);
+	M64_M64_M64             (HEX, _mm_andnot_si64);
+	M64_M64_M64             (HEX, _mm_or_si64);
+	M64_M64_M64             (HEX, _mm_xor_si64);
+	M64_M64_IMMI8           (HEX, _mm_slli_pi16, _immi8_0x02);
+	M64_M64_IMMI8           (HEX, _mm_slli_pi32, _immi8_0x1c);
+	M64_M64_IMMI8           (HEX, _mm_slli_si64, _immi8_0x1c);
+	M64_M64_IMMI8           (HEX, _mm_srli_pi16, _immi8_0x02);
+	M64_M64_IMMI8           (HEX, _mm_srli_pi32, _immi8_0x1c);
+	M64_M64_IMMI8           (HEX, _mm_srli_si64, _immi8_0x1c);
+	M64_M64_IMMI8           (HEX, _mm_srai_pi16, _immi8_0x1c);
+	M64_M64_IMMI8           (HEX, _mm_srai_pi32, _immi8_0x1c);
+	M64_M64_M64             (HEX, _mm_sll_pi16);
+	M64_M64_M64             (HEX, _mm_sll_pi32);
+	M64_M64_M64             (HEX, _mm_sll_si64);
+	M64_M64_M64             (HEX, _mm_srl_pi16);
+	M64_M64_M64             (HEX, _mm_srl_pi32);
+	M64_M64_M64             (HEX, _mm_srl_si64);
+	M64_M64_M64             (HEX, _mm_sra_pi16);
+	M64_M64_M64             (HEX, _mm_sra_pi32);
 	M128_V                  (HEX, _mm_setzero_ps);
 	M128D_V                 (HEX, _mm_setzero_pd);
 	M128_F32                (HEX, _mm_set1_ps);
@@ -90,6 +155,8 @@ int main()
 	M128D_F64P              (HEX, _mm_loaddup_pd);
 	M128_F32P               (HEX, _mm_load_ss);
 	M128D_F64P              (HEX, _mm_load_sd);
+	M128I_VP                (HEX, _mm_loadu_si16);
+	M128I_VP                (HEX, _mm_loadu_si32);
 	M128I_VP                (HEX, _mm_loadu_si64);
 	M128I_M128IP            (HEX, _mm_loadl_epi64);
 	TEST_MALLOC_AND_FREE    ();
@@ -135,6 +202,7 @@ int main()
 	M128I_M128I_IMMI8       (HEX, _mm_shufflelo_epi16, _immi8_0x1c);
 	M128D_M128D_M128D_IMMI8 (HEX, _mm_shuffle_pd, _immi8_0x02);
 	M128I_M128I_M128I_IMMI8 (HEX, _mm_blend_epi16, _immi8_0x1c);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_mpsadbw_epu8, _immi8_0x1c);
 	M128D_M128D_M128D_IMMI8 (HEX, _mm_blend_pd, _immi8_0x02);
 	M128_M128_M128_IMMI8    (HEX, _mm_blend_ps, _immi8_0x01);
 	M128I_M128I_M128I_M128I (HEX, _mm_blendv_epi8);
@@ -158,6 +226,9 @@ int main()
 	M128I_M128I_M128I       (HEX, _mm_srl_epi64);
 	I32_M128I               (HEX, _mm_movemask_epi8);
 	I32_M64                 (HEX, _mm_movemask_pi8);
+	V_M128I_M128I_VP        (HEX, _mm_maskmoveu_si128);
+	V_M64_M64_VP            (HEX, _mm_maskmove_si64);
+	V_M64_M64_VP            (HEX, _m_maskmovq);
 	I32_M64                 (HEX, _m_pmovmskb);
 	I32_M128                (HEX, _mm_movemask_ps);
 	I32_M128D               (HEX, _mm_movemask_pd);
@@ -253,6 +324,51 @@ int main()
 	M128D_M128D_M128D       (F64, _mm_sqrt_sd);
 	I32_U32                 (HEX, _mm_popcnt_u32);
 	I64_U64                 (HEX, _mm_popcnt_u32);
+	U32_U32_U32             (HEX, _mm_crc32_u8);
+	U32_U32_U32             (HEX, _mm_crc32_u16);
+	U32_U32_U32             (HEX, _mm_crc32_u32);
+	U64_U64_U64             (HEX, _mm_crc32_u64);
+	M128I_M128I_M128I       (HEX, _mm_aesenc_si128);
+	M128I_M128I_M128I       (HEX, _mm_aesenclast_si128);
+	M128I_M128I_M128I       (HEX, _mm_aesdec_si128);
+	M128I_M128I_M128I       (HEX, _mm_aesdeclast_si128);
+	M128I_M128I             (HEX, _mm_aesimc_si128);
+	M128I_M128I_IMMI8       (HEX, _mm_aeskeygenassist_si128, _immi8_0x01);
+	M128I_M128I_IMMI8       (HEX, _mm_aeskeygenassist_si128, _immi8_0x1c);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_clmulepi64_si128, _immi8_0x02);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_clmulepi64_si128, _immi8_0x01);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_clmulepi64_si128, _immi8_0x1c);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_clmulepi64_si128, _immi8_0x11);
+	M128I_M128I_M128I       (HEX, _mm_sha1msg1_epu32);
+	M128I_M128I_M128I       (HEX, _mm_sha1msg2_epu32);
+	M128I_M128I_M128I       (HEX, _mm_sha1nexte_epu32);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_sha1rnds4_epu32, _immi8_0x00);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_sha1rnds4_epu32, _immi8_0x01);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_sha1rnds4_epu32, _immi8_0x02);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_sha1rnds4_epu32, _immi8_0x03);
+	M128I_M128I_M128I       (HEX, _mm_sha256msg1_epu32);
+	M128I_M128I_M128I       (HEX, _mm_sha256msg2_epu32);
+	M128I_M128I_M128I_M128I (HEX, _mm_sha256rnds2_epu32);
+	M128_M128_M128_M128     (HEX, _mm_fmadd_ps);
+	M128_M128_M128_M128     (HEX, _mm_fmadd_ss);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmadd_pd);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmadd_sd);
+	M128_M128_M128_M128     (HEX, _mm_fmsub_ps);
+	M128_M128_M128_M128     (HEX, _mm_fmsub_ss);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmsub_pd);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmsub_sd);
+	M128_M128_M128_M128     (HEX, _mm_fnmadd_ps);
+	M128_M128_M128_M128     (HEX, _mm_fnmadd_ss);
+	M128D_M128D_M128D_M128D (HEX, _mm_fnmadd_pd);
+	M128D_M128D_M128D_M128D (HEX, _mm_fnmadd_sd);
+	M128_M128_M128_M128     (HEX, _mm_fnmsub_ps);
+	M128_M128_M128_M128     (HEX, _mm_fnmsub_ss);
+	M128D_M128D_M128D_M128D (HEX, _mm_fnmsub_pd);
+	M128D_M128D_M128D_M128D (HEX, _mm_fnmsub_sd);
+	M128_M128_M128_M128     (HEX, _mm_fmaddsub_ps);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmaddsub_pd);
+	M128_M128_M128_M128     (HEX, _mm_fmsubadd_ps);
+	M128D_M128D_M128D_M128D (HEX, _mm_fmsubadd_pd);
 	M128_M128_M128          (HEX, _mm_max_ps);
 	M128_M128_M128          (HEX, _mm_max_ss);
 	M128D_M128D_M128D       (HEX, _mm_max_pd);
@@ -333,6 +449,20 @@ int main()
 	M128I_M128I_M128I       (HEX, _mm_cmpgt_epi16);
 	M128I_M128I_M128I       (HEX, _mm_cmpgt_epi32);
 	M128I_M128I_M128I       (HEX, _mm_cmpgt_epi64);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistri, _immi8_0x1c);
+	M128I_M128I_M128I_IMMI8 (HEX, _mm_cmpistrm, _immi8_0x01);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistra, _immi8_0x1c);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistrc, _immi8_0x1c);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistro, _immi8_0x1c);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistrs, _immi8_0x1c);
+	I32_M128I_M128I_IMMI8   (HEX, _mm_cmpistrz, _immi8_0x1c);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestri, _immi8_0x02);
+	M128I_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestrm, _immi8_0x1c);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestra, _immi8_0x02);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestrc, _immi8_0x02);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestro, _immi8_0x02);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestrs, _immi8_0x02);
+	I32_M128I_I32_M128I_I32_IMMI8 (HEX, _mm_cmpestrz, _immi8_0x02);
 	M128_M128_M128          (HEX, _mm_cmpord_ps);
 	M128_M128_M128          (HEX, _mm_cmpord_ss);
 	M128D_M128D_M128D       (HEX, _mm_cmpord_pd);
@@ -473,6 +603,7 @@ int main()
 	M128I_M128I_I32_IMMI8   (HEX, _mm_insert_epi16, _immi8_0x02);
 	M64_M64_I32_IMMI8       (HEX, _mm_insert_pi16, _immi8_0x02);
 	M128I_M128I_I32_IMMI8   (HEX, _mm_insert_epi32, _immi8_0x02);
+	M128_M128_M128_IMMI8    (HEX, _mm_insert_ps, _immi8_0x1c);
 	M128I_M128I_I32_IMMI8   (HEX, _mm_insert_epi64, _immi8_0x01);
 	I32_M64_IMMI8           (HEX, _m_pextrw, _immi8_0x02);
 	M64_M64_I32_IMMI8       (HEX, _m_pinsrw, _immi8_0x02);
@@ -486,5 +617,7 @@ int main()
 	M64_M64_M64_IMMI8       (HEX, _mm_alignr_pi8, _immi8_0x1c);
 	V_TEST                  (_mm_pause);
 	V_TEST                  (_mm_sfence);
+	V_TEST                  (_mm_lfence);
+	V_TEST                  (_mm_mfence);
 	return 0;
 }